@@ -8,6 +8,8 @@
 Alarm::Alarm(std::unique_ptr<Delegate> delegate)
     : deadline_(TimeBase::zero()), delegate_(std::move(delegate)) {}
 
+Alarm::Alarm() : deadline_(TimeBase::zero()), delegate_() {}
+
 void Alarm::set(TimeBase new_deadline) {
   DCHECK(!isSet());
   DCHECK(new_deadline.isInitialized());
@@ -30,7 +32,11 @@ void Alarm::fire() {
     return;
   }
   deadline_ = TimeBase::zero();
-  delegate_->onAlarm();
+  if (delegate_ != nullptr) {
+    delegate_->onAlarm();
+  } else {
+    onAlarm();
+  }
 }
 
 void Alarm::update(TimeBase new_deadline, TimeBase::Delta granularity) {
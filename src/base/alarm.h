@@ -46,6 +46,12 @@ public:
   void fire();
 
 protected:
+  // For alarms that dispatch by themselves in |onAlarm|.
+  Alarm();
+
+  // Called on firing if the alarm has no delegate.
+  virtual void onAlarm() {}
+
   /**
    * @brief Actions that are performed when setting/canceling/updating an alarm.
    *
@@ -61,6 +67,8 @@ private:
 
 /**
  * @brief Macro utility for defining an alarm delegate.
+ * Prefer MemberAlarm for alarms that live as long as their owner, it needs
+ * neither a delegate nor a factory allocation.
  * A typical use is to set `class_base` to the class itself
  * when defining a delegate in a class and set `action` to
  * a method of the class.
@@ -7,6 +7,8 @@
 
 #include "alarm.h"
 
+class EmbeddedAlarm;
+
 /**
  * @brief AlarmFactory is responsable for creating all alarms.
  * This is a base class and derived classes should be defined to
@@ -17,6 +19,10 @@ public:
   virtual ~AlarmFactory() = default;
   virtual Alarm *createAlarm(std::unique_ptr<Alarm::Delegate> delegate) = 0;
   virtual TimeBase now() = 0;
+
+  // Arm and disarm an alarm embedded in its owner, @see EmbeddedAlarm
+  virtual void registerAlarm(EmbeddedAlarm *alarm) = 0;
+  virtual void unregisterAlarm(EmbeddedAlarm *alarm) = 0;
 };
 
 #endif // SRC_BASE_ALARM_FACTORY_H
@@ -3,26 +3,34 @@
 //
 
 #include "checksum.h"
+#include "checksum_kernel.h"
 #include <cstddef>
 #include <netinet/in.h>
 
-Checksum::Checksum(const char *begin, const char *end) {
-  size_t length = end - begin;
-  uint32_t sum = 0;
-  if (length & 1u) {
-    end -= 1;
-    sum = (uint16_t)(*((uint8_t *)end)) << 8u;
-  }
+Checksum::Checksum(const char *begin, const char *end) : Checksum() {
+  add(begin, end);
+}
 
-  auto *data = (uint16_t *)begin;
-  auto *data_end = (uint16_t *)end;
-  while (data < data_end) {
-    sum += ntohs(*data);
-    sum = (sum & 0xffffu) + ((sum >> 16u));
-    data += 1;
-  }
+void Checksum::add(const char *begin, const char *end) {
+  const size_t length = end - begin;
+  addSum(ChecksumKernel::sum(begin, length), length);
+}
 
-  sum_ = sum;
+void Checksum::copyAndAdd(char *destination, const char *begin,
+                          const char *end) {
+  const size_t length = end - begin;
+  addSum(ChecksumKernel::copyAndSum(destination, begin, length), length);
+}
+
+// Add the kernel sum of |length| bytes.
+void Checksum::addSum(uint64_t kernel_sum, size_t length) {
+  uint16_t sum = ntohs(ChecksumKernel::fold(kernel_sum));
+  if (odd_) {
+    // the bytes are shifted by one position in their 16-bit words
+    sum = static_cast<uint16_t>((sum << 8u) | (sum >> 8u));
+  }
+  addHostUInt16(sum);
+  odd_ ^= (length & 1u) != 0;
 }
 
 void Checksum::addHostUInt16(uint16_t value) {
@@ -34,8 +42,9 @@ void Checksum::addHostUInt16(uint16_t value) {
 
 void Checksum::addIPAddress(IPAddress ip_address) {
   uint32_t buffer;
-  DataWriter writer((char *)&buffer, 8);
-  DCHECK(ip_address.writeTo(&writer));
+  DataWriter writer((char *)&buffer, sizeof(buffer));
+  bool written = ip_address.writeTo(&writer);
+  DCHECK(written);
   addNetworkUint16(buffer >> 16u);
   addNetworkUint16(buffer);
 }
@@ -50,3 +59,24 @@ void Checksum::addNetworkUint16(uint16_t value) {
   value = ntohs(value);
   addHostUInt16(value);
 }
+
+void Checksum::replace16(char *field, uint16_t old_value, uint16_t new_value) {
+  auto *bytes = reinterpret_cast<uint8_t *>(field);
+  uint16_t checksum = (bytes[0] << 8u) | bytes[1];
+
+  // HC' = ~(~HC + ~m + m')
+  uint32_t sum = static_cast<uint16_t>(~checksum);
+  sum += static_cast<uint16_t>(~old_value);
+  sum += new_value;
+  sum = (sum & 0xffffu) + (sum >> 16u);
+  sum = (sum & 0xffffu) + (sum >> 16u);
+
+  checksum = ~sum;
+  bytes[0] = checksum >> 8u;
+  bytes[1] = checksum;
+}
+
+void Checksum::replace32(char *field, uint32_t old_value, uint32_t new_value) {
+  replace16(field, old_value >> 16u, new_value >> 16u);
+  replace16(field, old_value, new_value);
+}
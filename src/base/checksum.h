@@ -8,12 +8,24 @@
 #include "../ip/ip_address.h"
 #include <cstdint>
 
+/**
+ * @brief The Internet checksum of RFC 1071.
+ * Buffers can be added piece by piece with |add|, so a header, the pseudo
+ * header and a payload are summed without being copied together.
+ * @see ChecksumKernel
+ */
 class Checksum {
 public:
-  Checksum() = default;
+  Checksum() : sum_(0), odd_(false) {}
 
   Checksum(const char *begin, const char *end);
 
+  // Add the bytes in [begin, end) following the bytes added so far.
+  void add(const char *begin, const char *end);
+
+  // Copy [begin, end) to |destination| and add the bytes in the same pass.
+  void copyAndAdd(char *destination, const char *begin, const char *end);
+
   inline uint16_t getChecksum() { return sum_; }
 
   void addHostUInt16(uint16_t value);
@@ -24,9 +36,24 @@ public:
 
   void writeTo(char *buffer);
 
+  /**
+   * @brief Fix the checksum field at |field| after a 16-bit word covered by
+   * it changed from |old_value| to |new_value|, both in host endianness.
+   * The cost does not depend on the length of the covered data.
+   * @see RFC 1624 section 3, equation 3
+   */
+  static void replace16(char *field, uint16_t old_value, uint16_t new_value);
+
+  // Same as |replace16| for an aligned 32-bit word, e.g. an IPv4 address.
+  static void replace32(char *field, uint32_t old_value, uint32_t new_value);
+
 private:
+  void addSum(uint64_t kernel_sum, size_t length);
+
   // in host endianness
   uint16_t sum_;
+  // an odd number of bytes were added, the next byte is a low byte
+  bool odd_;
 };
 
 #endif // SRC_BASE_CHECKSUM_H
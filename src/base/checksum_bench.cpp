@@ -0,0 +1,102 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+/**
+ * @file checksum_bench.cpp
+ * @brief Compare the checksum kernels with the former implementation, which
+ * folded one 16-bit word at a time.
+ */
+
+#include "checksum.h"
+#include "checksum_kernel.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <vector>
+
+namespace {
+
+uint16_t legacyChecksum(const char *begin, const char *end) {
+  size_t length = end - begin;
+  uint32_t sum = 0;
+  if (length & 1u) {
+    end -= 1;
+    sum = (uint16_t)(*((uint8_t *)end)) << 8u;
+  }
+
+  auto *data = (uint16_t *)begin;
+  auto *data_end = (uint16_t *)end;
+  while (data < data_end) {
+    sum += ntohs(*data);
+    sum = (sum & 0xffffu) + ((sum >> 16u));
+    data += 1;
+  }
+  return sum;
+}
+
+template <class Func>
+double measure(const std::vector<char> &data, size_t length, Func func) {
+  const size_t kTotalBytes = 1ull << 30;
+  const size_t rounds = kTotalBytes / length;
+  volatile uint16_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; i++) {
+    sink = sink + func(data.data(), data.data() + length);
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  // GB/s
+  return rounds * length / elapsed.count() / 1e9;
+}
+
+const char *nameOf(ChecksumKernel::Type type) {
+  switch (type) {
+  case ChecksumKernel::Type::SCALAR:
+    return "scalar";
+  case ChecksumKernel::Type::SSE2:
+    return "sse2";
+  case ChecksumKernel::Type::AVX2:
+    return "avx2";
+  case ChecksumKernel::Type::AVX512:
+    return "avx512";
+  }
+  return "unknown";
+}
+
+} // namespace
+
+int main() {
+  std::vector<char> data(65536);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i * 131 + 7);
+  }
+
+  const ChecksumKernel::Type kTypes[] = {
+      ChecksumKernel::Type::SCALAR, ChecksumKernel::Type::SSE2,
+      ChecksumKernel::Type::AVX2, ChecksumKernel::Type::AVX512};
+
+  std::cout << std::setw(8) << "bytes" << std::setw(10) << "legacy";
+  for (auto type : kTypes) {
+    std::cout << std::setw(10) << nameOf(type);
+  }
+  std::cout << "  (GB/s)" << std::endl;
+
+  for (size_t length : {20, 64, 576, 1500, 9000, 65536}) {
+    std::cout << std::setw(8) << length << std::setw(10) << std::fixed
+              << std::setprecision(2) << measure(data, length, legacyChecksum);
+    for (auto type : kTypes) {
+      if (!ChecksumKernel::select(type)) {
+        std::cout << std::setw(10) << "-";
+        continue;
+      }
+      auto checksum = [](const char *begin, const char *end) {
+        return Checksum(begin, end).getChecksum();
+      };
+      std::cout << std::setw(10) << measure(data, length, checksum);
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
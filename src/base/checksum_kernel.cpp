@@ -0,0 +1,318 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "checksum_kernel.h"
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef uint64_t (*SumFunction)(const uint8_t *data, size_t length);
+typedef uint64_t (*CopyFunction)(uint8_t *destination, const uint8_t *data,
+                                 size_t length);
+
+const size_t kMinVectorLength = 64;
+
+uint64_t sumScalar(const uint8_t *data, size_t length) {
+  uint64_t sum = 0;
+  while (length >= 8) {
+    uint64_t value;
+    memcpy(&value, data, 8);
+    // two 32-bit halves never overflow the 64-bit accumulator
+    sum += (value & 0xffffffffu) + (value >> 32u);
+    data += 8;
+    length -= 8;
+  }
+  while (length >= 2) {
+    uint16_t value;
+    memcpy(&value, data, 2);
+    sum += value;
+    data += 2;
+    length -= 2;
+  }
+  if (length > 0) {
+#if __BIG_ENDIAN__
+    sum += static_cast<uint64_t>(*data) << 8u;
+#else
+    sum += *data;
+#endif
+  }
+  return sum;
+}
+
+uint64_t copyScalar(uint8_t *destination, const uint8_t *data,
+                    size_t length) {
+  uint64_t sum = 0;
+  while (length >= 8) {
+    uint64_t value;
+    memcpy(&value, data, 8);
+    memcpy(destination, &value, 8);
+    sum += (value & 0xffffffffu) + (value >> 32u);
+    destination += 8;
+    data += 8;
+    length -= 8;
+  }
+  memcpy(destination, data, length);
+  return sum + sumScalar(data, length);
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse2"))) uint64_t sumSse2(const uint8_t *data,
+                                                   size_t length) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i low = zero;
+  __m128i high = zero;
+  while (length >= 32) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16));
+    // widen the 32-bit words to 64-bit lanes
+    low = _mm_add_epi64(low, _mm_unpacklo_epi32(a, zero));
+    high = _mm_add_epi64(high, _mm_unpackhi_epi32(a, zero));
+    low = _mm_add_epi64(low, _mm_unpacklo_epi32(b, zero));
+    high = _mm_add_epi64(high, _mm_unpackhi_epi32(b, zero));
+    data += 32;
+    length -= 32;
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes),
+                   _mm_add_epi64(low, high));
+  return lanes[0] + lanes[1] + sumScalar(data, length);
+}
+
+__attribute__((target("sse2"))) uint64_t
+copySse2(uint8_t *destination, const uint8_t *data, size_t length) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i low = zero;
+  __m128i high = zero;
+  while (length >= 16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(destination), a);
+    low = _mm_add_epi64(low, _mm_unpacklo_epi32(a, zero));
+    high = _mm_add_epi64(high, _mm_unpackhi_epi32(a, zero));
+    destination += 16;
+    data += 16;
+    length -= 16;
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes),
+                   _mm_add_epi64(low, high));
+  return lanes[0] + lanes[1] + copyScalar(destination, data, length);
+}
+
+__attribute__((target("avx2"))) uint64_t sumAvx2(const uint8_t *data,
+                                                   size_t length) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i low = zero;
+  __m256i high = zero;
+  while (length >= 64) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+    __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 32));
+    low = _mm256_add_epi64(low, _mm256_unpacklo_epi32(a, zero));
+    high = _mm256_add_epi64(high, _mm256_unpackhi_epi32(a, zero));
+    low = _mm256_add_epi64(low, _mm256_unpacklo_epi32(b, zero));
+    high = _mm256_add_epi64(high, _mm256_unpackhi_epi32(b, zero));
+    data += 64;
+    length -= 64;
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes),
+                      _mm256_add_epi64(low, high));
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumSse2(data, length);
+}
+
+__attribute__((target("avx2"))) uint64_t
+copyAvx2(uint8_t *destination, const uint8_t *data, size_t length) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i low = zero;
+  __m256i high = zero;
+  while (length >= 32) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination), a);
+    low = _mm256_add_epi64(low, _mm256_unpacklo_epi32(a, zero));
+    high = _mm256_add_epi64(high, _mm256_unpackhi_epi32(a, zero));
+    destination += 32;
+    data += 32;
+    length -= 32;
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes),
+                      _mm256_add_epi64(low, high));
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+         copySse2(destination, data, length);
+}
+
+__attribute__((target("avx512f"))) uint64_t sumAvx512(const uint8_t *data,
+                                                        size_t length) {
+  const __m512i zero = _mm512_setzero_si512();
+  __m512i low = zero;
+  __m512i high = zero;
+  while (length >= 128) {
+    __m512i a = _mm512_loadu_si512(data);
+    __m512i b = _mm512_loadu_si512(data + 64);
+    low = _mm512_add_epi64(low, _mm512_unpacklo_epi32(a, zero));
+    high = _mm512_add_epi64(high, _mm512_unpackhi_epi32(a, zero));
+    low = _mm512_add_epi64(low, _mm512_unpacklo_epi32(b, zero));
+    high = _mm512_add_epi64(high, _mm512_unpackhi_epi32(b, zero));
+    data += 128;
+    length -= 128;
+  }
+  return _mm512_reduce_add_epi64(_mm512_add_epi64(low, high)) +
+         sumAvx2(data, length);
+}
+
+__attribute__((target("avx512f"))) uint64_t
+copyAvx512(uint8_t *destination, const uint8_t *data, size_t length) {
+  const __m512i zero = _mm512_setzero_si512();
+  __m512i low = zero;
+  __m512i high = zero;
+  while (length >= 64) {
+    __m512i a = _mm512_loadu_si512(data);
+    _mm512_storeu_si512(destination, a);
+    low = _mm512_add_epi64(low, _mm512_unpacklo_epi32(a, zero));
+    high = _mm512_add_epi64(high, _mm512_unpackhi_epi32(a, zero));
+    destination += 64;
+    data += 64;
+    length -= 64;
+  }
+  return _mm512_reduce_add_epi64(_mm512_add_epi64(low, high)) +
+         copyAvx2(destination, data, length);
+}
+
+#endif
+
+SumFunction sumFunctionOf(ChecksumKernel::Type type) {
+  switch (type) {
+#if defined(__x86_64__)
+  case ChecksumKernel::Type::SSE2:
+    return sumSse2;
+  case ChecksumKernel::Type::AVX2:
+    return sumAvx2;
+  case ChecksumKernel::Type::AVX512:
+    return sumAvx512;
+#endif
+  default:
+    return sumScalar;
+  }
+}
+
+CopyFunction copyFunctionOf(ChecksumKernel::Type type) {
+  switch (type) {
+#if defined(__x86_64__)
+  case ChecksumKernel::Type::SSE2:
+    return copySse2;
+  case ChecksumKernel::Type::AVX2:
+    return copyAvx2;
+  case ChecksumKernel::Type::AVX512:
+    return copyAvx512;
+#endif
+  default:
+    return copyScalar;
+  }
+}
+
+ChecksumKernel::Type fastestType() {
+  for (auto type : {ChecksumKernel::Type::AVX512, ChecksumKernel::Type::AVX2,
+                    ChecksumKernel::Type::SSE2}) {
+    if (ChecksumKernel::isSupported(type)) {
+      return type;
+    }
+  }
+  return ChecksumKernel::Type::SCALAR;
+}
+
+uint64_t sumFirstCall(const uint8_t *data, size_t length);
+uint64_t copyFirstCall(uint8_t *destination, const uint8_t *data,
+                       size_t length);
+
+// constant-initialized, so the kernels work in static constructors
+std::atomic<SumFunction> selected_function(sumFirstCall);
+std::atomic<CopyFunction> selected_copy_function(copyFirstCall);
+std::atomic<ChecksumKernel::Type> selected_type(ChecksumKernel::Type::SCALAR);
+
+uint64_t sumFirstCall(const uint8_t *data, size_t length) {
+  ChecksumKernel::select(fastestType());
+  return ChecksumKernel::sum(data, length);
+}
+
+uint64_t copyFirstCall(uint8_t *destination, const uint8_t *data,
+                       size_t length) {
+  ChecksumKernel::select(fastestType());
+  return ChecksumKernel::copyAndSum(destination, data, length);
+}
+
+} // namespace
+
+uint64_t ChecksumKernel::sum(const void *data, size_t length) {
+  if (length < kMinVectorLength) {
+    // headers are too short to pay off the vector setup and reduction
+    return sumScalar(static_cast<const uint8_t *>(data), length);
+  }
+  return selected_function.load(std::memory_order_relaxed)(
+      static_cast<const uint8_t *>(data), length);
+}
+
+uint64_t ChecksumKernel::copyAndSum(void *destination, const void *data,
+                                    size_t length) {
+  if (length < kMinVectorLength) {
+    return copyScalar(static_cast<uint8_t *>(destination),
+                      static_cast<const uint8_t *>(data), length);
+  }
+  return selected_copy_function.load(std::memory_order_relaxed)(
+      static_cast<uint8_t *>(destination), static_cast<const uint8_t *>(data),
+      length);
+}
+
+uint16_t ChecksumKernel::fold(uint64_t sum) {
+  sum = (sum & 0xffffffffu) + (sum >> 32u);
+  sum = (sum & 0xffffffffu) + (sum >> 32u);
+  sum = (sum & 0xffffu) + (sum >> 16u);
+  sum = (sum & 0xffffu) + (sum >> 16u);
+  return static_cast<uint16_t>(sum);
+}
+
+bool ChecksumKernel::isSupported(Type type) {
+#if defined(__x86_64__)
+  // may run before the constructor of libgcc that fills the CPU model
+  __builtin_cpu_init();
+#endif
+  switch (type) {
+  case Type::SCALAR:
+    return true;
+#if defined(__x86_64__)
+  case Type::SSE2:
+    return __builtin_cpu_supports("sse2");
+  case Type::AVX2:
+    return __builtin_cpu_supports("avx2");
+  case Type::AVX512:
+    return __builtin_cpu_supports("avx512f");
+#endif
+  default:
+    return false;
+  }
+}
+
+bool ChecksumKernel::select(Type type) {
+  if (!isSupported(type)) {
+    return false;
+  }
+  selected_type.store(type, std::memory_order_relaxed);
+  selected_function.store(sumFunctionOf(type), std::memory_order_relaxed);
+  selected_copy_function.store(copyFunctionOf(type),
+                               std::memory_order_relaxed);
+  return true;
+}
+
+ChecksumKernel::Type ChecksumKernel::selected() {
+  if (selected_function.load(std::memory_order_relaxed) == sumFirstCall) {
+    select(fastestType());
+  }
+  return selected_type.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,53 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_CHECKSUM_KERNEL_H
+#define SRC_BASE_CHECKSUM_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Vectorized one's-complement sum of RFC 1071.
+ * The words are loaded in memory order and added to 64-bit accumulators, the
+ * carries are folded only once at the end. The sum of words loaded in host
+ * order is the byte-swapped sum of words in network order, so the caller
+ * converts the folded result with |ntohs|.
+ *
+ * The fastest kernel supported by the CPU is selected at startup.
+ */
+class ChecksumKernel {
+public:
+  enum class Type {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512,
+  };
+
+  /**
+   * @brief The unfolded sum of |length| bytes at |data|. A trailing odd
+   * byte is padded with zero as if it was at an even offset.
+   */
+  static uint64_t sum(const void *data, size_t length);
+
+  /**
+   * @brief Copy |length| bytes from |data| to |destination| and return the
+   * same sum as |sum|, reading every byte only once.
+   */
+  static uint64_t copyAndSum(void *destination, const void *data,
+                             size_t length);
+
+  // Fold a sum to 16 bits, still in memory order.
+  static uint16_t fold(uint64_t sum);
+
+  static bool isSupported(Type type);
+
+  // Use |type| for |sum|, false if the CPU does not support it.
+  static bool select(Type type);
+
+  static Type selected();
+};
+
+#endif // SRC_BASE_CHECKSUM_KERNEL_H
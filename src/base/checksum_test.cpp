@@ -0,0 +1,147 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "checksum.h"
+#include "checksum_kernel.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <netinet/in.h>
+#include <random>
+#include <vector>
+
+namespace {
+
+// one 16-bit word at a time in network order
+uint16_t referenceSum(const uint8_t *data, size_t length) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i + 1 < length; i += 2) {
+    sum += (data[i] << 8u) | data[i + 1];
+    sum = (sum & 0xffffu) + (sum >> 16u);
+  }
+  if (length & 1u) {
+    sum += data[length - 1] << 8u;
+    sum = (sum & 0xffffu) + (sum >> 16u);
+  }
+  return sum;
+}
+
+} // namespace
+
+class ChecksumTest : public testing::TestWithParam<ChecksumKernel::Type> {
+protected:
+  void SetUp() override {
+    if (!ChecksumKernel::select(GetParam())) {
+      GTEST_SKIP() << "not supported by the CPU";
+    }
+  }
+
+  void TearDown() override { ChecksumKernel::select(default_); }
+
+  ChecksumKernel::Type default_ = ChecksumKernel::selected();
+};
+
+TEST_P(ChecksumTest, Rfc1071) {
+  // the example in RFC 1071 section 3
+  const char data[] = {0x00, 0x01, (char)0xf2, 0x03,
+                       (char)0xf4, (char)0xf5, (char)0xf6, (char)0xf7};
+  Checksum checksum(data, data + sizeof(data));
+  EXPECT_EQ(checksum.getChecksum(), 0xddf2);
+}
+
+TEST_P(ChecksumTest, Random) {
+  std::mt19937 rand(20261018);
+  std::vector<uint8_t> data(4096 + 64);
+  for (auto &byte : data) {
+    byte = static_cast<uint8_t>(rand());
+  }
+  for (size_t length = 0; length <= 600; length++) {
+    for (size_t offset = 0; offset < 4; offset++) {
+      const char *begin = reinterpret_cast<const char *>(data.data()) + offset;
+      Checksum checksum(begin, begin + length);
+      ASSERT_EQ(checksum.getChecksum(),
+                referenceSum(data.data() + offset, length))
+          << "length " << length << " offset " << offset;
+    }
+  }
+  const char *begin = reinterpret_cast<const char *>(data.data());
+  Checksum checksum(begin, begin + 4096);
+  EXPECT_EQ(checksum.getChecksum(), referenceSum(data.data(), 4096));
+}
+
+TEST_P(ChecksumTest, Pieces) {
+  std::vector<char> data(1500);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i * 7 + 3);
+  }
+  Checksum whole(data.data(), data.data() + data.size());
+
+  // split at odd and even offsets
+  for (size_t first : {0, 1, 20, 33, 1499}) {
+    for (size_t second : {first, first + 1, first + 2, first + 7}) {
+      second = std::min(second, data.size());
+      Checksum checksum;
+      checksum.add(data.data(), data.data() + first);
+      checksum.add(data.data() + first, data.data() + second);
+      checksum.add(data.data() + second, data.data() + data.size());
+      EXPECT_EQ(checksum.getChecksum(), whole.getChecksum())
+          << first << " " << second;
+    }
+  }
+}
+
+TEST_P(ChecksumTest, CopyAndAdd) {
+  std::vector<char> data(1600), copy(1600);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i * 13 + 5);
+  }
+  for (size_t length : {0, 1, 7, 63, 64, 65, 200, 1500}) {
+    for (size_t offset = 0; offset < 3; offset++) {
+      std::fill(copy.begin(), copy.end(), 0);
+      Checksum checksum;
+      checksum.copyAndAdd(copy.data() + offset, data.data(),
+                          data.data() + length);
+      EXPECT_TRUE(std::equal(data.begin(), data.begin() + length,
+                             copy.begin() + offset));
+      EXPECT_EQ(copy[offset + length], 0);
+      EXPECT_EQ(checksum.getChecksum(),
+                referenceSum(reinterpret_cast<uint8_t *>(data.data()), length))
+          << length;
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, ChecksumTest,
+                         testing::Values(ChecksumKernel::Type::SCALAR,
+                                         ChecksumKernel::Type::SSE2,
+                                         ChecksumKernel::Type::AVX2,
+                                         ChecksumKernel::Type::AVX512));
+
+TEST(ChecksumReplaceTest, Replace) {
+  std::mt19937 rand(1624);
+  char header[20];
+  for (int round = 0; round < 1000; round++) {
+    for (auto &byte : header) {
+      byte = static_cast<char>(rand());
+    }
+    header[10] = header[11] = 0;
+    Checksum(header, header + sizeof(header)).writeTo(header + 10);
+
+    // decrement the TTL
+    auto old16 = static_cast<uint16_t>(((uint8_t)header[8] << 8u) |
+                                       (uint8_t)header[9]);
+    auto new16 = static_cast<uint16_t>(rand());
+    header[8] = static_cast<char>(new16 >> 8u);
+    header[9] = static_cast<char>(new16);
+    Checksum::replace16(header + 10, old16, new16);
+
+    // rewrite the destination address
+    uint32_t old32 = ntohl(*reinterpret_cast<uint32_t *>(header + 16));
+    uint32_t new32 = rand();
+    *reinterpret_cast<uint32_t *>(header + 16) = htonl(new32);
+    Checksum::replace32(header + 10, old32, new32);
+
+    // a valid header sums to 0xffff
+    ASSERT_EQ(Checksum(header, header + sizeof(header)).getChecksum(), 0xffff);
+  }
+}
@@ -0,0 +1,156 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "clock.h"
+#include <cmath>
+#include <cstring>
+#include <glog/logging.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+int64_t readClock(clockid_t clock_id) {
+  struct timespec ts {};
+  if (clock_gettime(clock_id, &ts) < 0) {
+    LOG(FATAL) << "clock_gettime: " << strerror(errno);
+  }
+  return ts.tv_sec * 1000 * 1000 + ts.tv_nsec / 1000;
+}
+
+} // namespace
+
+std::unique_ptr<Clock> Clock::create(ClockType type) {
+  switch (type) {
+  case ClockType::MONOTONIC:
+    return std::make_unique<PosixClock>(CLOCK_MONOTONIC);
+  case ClockType::MONOTONIC_COARSE:
+    return std::make_unique<PosixClock>(CLOCK_MONOTONIC_COARSE);
+  case ClockType::TSC:
+    if (TscClock::isSupported()) {
+      return std::make_unique<TscClock>();
+    }
+    LOG(ERROR) << "no invariant TSC, fall back to CLOCK_MONOTONIC";
+    return std::make_unique<PosixClock>(CLOCK_MONOTONIC);
+  }
+  return nullptr;
+}
+
+PosixClock::PosixClock(clockid_t clock_id) : clock_id_(clock_id) {}
+
+TimeBase PosixClock::now() {
+  // CLOCK_MONOTONIC counts from boot, so it is never zero in practice
+  return TimeBase(readClock(clock_id_));
+}
+
+TscClock::TscClock()
+    : start_tsc_(0), start_us_(0), base_tsc_(0), base_us_(0), mult_(0),
+      resync_cycles_(0), last_us_(0) {
+  calibrate();
+}
+
+/**
+ * @brief Check whether the TSC ticks at a constant rate regardless of
+ * frequency scaling and sleep states.
+ */
+bool TscClock::isSupported() {
+#if defined(__x86_64__)
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 ||
+      eax < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  return (edx & (1u << 8u)) != 0;
+#else
+  return false;
+#endif
+}
+
+#if defined(__x86_64__)
+
+namespace {
+
+/**
+ * @brief Sample CLOCK_MONOTONIC and the TSC at (nearly) the same instant.
+ * The TSC value is the midpoint of two reads around clock_gettime().
+ */
+void sampleTsc(uint64_t *tsc, int64_t *us) {
+  uint64_t before = __rdtsc();
+  *us = readClock(CLOCK_MONOTONIC);
+  uint64_t after = __rdtsc();
+  *tsc = before + (after - before) / 2;
+}
+
+} // namespace
+
+/**
+ * @brief Measure the TSC frequency against CLOCK_MONOTONIC for 10 ms.
+ * The TSC timeline starts from CLOCK_MONOTONIC so that both clocks are
+ * comparable.
+ */
+void TscClock::calibrate() {
+  const int64_t kCalibrationUs = 10 * 1000;
+
+  sampleTsc(&start_tsc_, &start_us_);
+  do {
+    sampleTsc(&base_tsc_, &base_us_);
+  } while (base_us_ - start_us_ < kCalibrationUs);
+
+  DCHECK(base_tsc_ > start_tsc_);
+  mult_ = (uint64_t)(((unsigned __int128)(base_us_ - start_us_) << kShift) /
+                     (base_tsc_ - start_tsc_));
+  // cycles per second
+  resync_cycles_ = (base_tsc_ - start_tsc_) * 100;
+  last_us_ = base_us_;
+  LOG(INFO) << "TSC frequency: "
+            << (base_tsc_ - start_tsc_) / (base_us_ - start_us_) << " MHz";
+}
+
+/**
+ * @brief Re-anchor the TSC timeline to CLOCK_MONOTONIC about once a second.
+ * The frequency is measured over the whole lifetime of the clock, so the
+ * estimation keeps improving and the drift between two resyncs stays small.
+ */
+void TscClock::resync() {
+  sampleTsc(&base_tsc_, &base_us_);
+  mult_ = (uint64_t)(((unsigned __int128)(base_us_ - start_us_) << kShift) /
+                     (base_tsc_ - start_tsc_));
+}
+
+double TscClock::nanosecondsPerCycle() const {
+  return std::ldexp(static_cast<double>(mult_) * 1000, -kShift);
+}
+
+TimeBase TscClock::now() {
+  uint64_t tsc = __rdtsc();
+  if (unlikely(tsc - base_tsc_ > resync_cycles_)) {
+    resync();
+    tsc = base_tsc_;
+  }
+  uint64_t cycles = tsc - base_tsc_;
+  int64_t us =
+      base_us_ + (int64_t)(((unsigned __int128)cycles * mult_) >> kShift);
+  // a resync may step the timeline backwards by a few microseconds
+  if (us < last_us_) {
+    us = last_us_;
+  }
+  last_us_ = us;
+  return TimeBase(us);
+}
+
+#else
+
+void TscClock::calibrate() {}
+
+void TscClock::resync() {}
+
+TimeBase TscClock::now() { return TimeBase(readClock(CLOCK_MONOTONIC)); }
+
+double TscClock::nanosecondsPerCycle() const { return 0; }
+
+#endif
@@ -0,0 +1,86 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_CLOCK_H
+#define SRC_BASE_CLOCK_H
+
+#include "time_base.h"
+#include "util.h"
+#include <ctime>
+
+enum class ClockType {
+  // CLOCK_MONOTONIC, accurate and never stepped by NTP
+  MONOTONIC,
+  // CLOCK_MONOTONIC_COARSE, cheaper but only has jiffy resolution
+  MONOTONIC_COARSE,
+  // rdtsc calibrated against CLOCK_MONOTONIC, falls back to MONOTONIC
+  // if the CPU has no invariant TSC
+  TSC,
+};
+
+/**
+ * @brief Clock is the time source of TimeBase.
+ * All clocks are monotonic, so the time they produce can be used to order
+ * alarms and to sample RTTs. Note that TimeBase::zero() is reserved for
+ * uninitialized time and is never returned.
+ */
+class Clock {
+public:
+  DISALLOW_COPY_AND_ASSIGN(Clock)
+  Clock() = default;
+  virtual ~Clock() = default;
+
+  virtual TimeBase now() = 0;
+
+  static std::unique_ptr<Clock> create(ClockType type);
+};
+
+class PosixClock : public Clock {
+public:
+  explicit PosixClock(clockid_t clock_id);
+
+  TimeBase now() override;
+
+private:
+  clockid_t clock_id_;
+};
+
+class TscClock : public Clock {
+public:
+  TscClock();
+
+  TimeBase now() override;
+
+  static bool isSupported();
+
+  // The raw time stamp counter, cheaper than |now| but in cycles.
+  static inline uint64_t readCycles() {
+#if defined(__x86_64__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  // The length of a cycle of |readCycles| as calibrated.
+  double nanosecondsPerCycle() const;
+
+private:
+  void calibrate();
+  void resync();
+
+  // the first sample, the frequency is refined over the whole lifetime
+  uint64_t start_tsc_;
+  int64_t start_us_;
+  // the last sample, |now()| extrapolates from it
+  uint64_t base_tsc_;
+  int64_t base_us_;
+  // microseconds per cycle in fixed point with |kShift| fraction bits
+  uint64_t mult_;
+  uint64_t resync_cycles_;
+  int64_t last_us_;
+  static const int kShift = 40;
+};
+
+#endif // SRC_BASE_CLOCK_H
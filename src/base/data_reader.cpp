@@ -57,6 +57,15 @@ bool DataReader::skip(size_t length) {
   return true;
 }
 
+char *DataReader::consume(size_t length) {
+  if (pos_ + length > capacity_) {
+    return nullptr;
+  }
+  char *rv = buffer_ + pos_;
+  pos_ += length;
+  return rv;
+}
+
 bool DataReader::readBytes(void *result, size_t length) {
   if (pos_ + length > capacity_) {
     return false;
@@ -20,6 +20,16 @@ public:
 
   bool skip(size_t length);
 
+  // Consume |length| bytes at once, nullptr if the buffer is shorter.
+  char *consume(size_t length);
+
+  /* Consume a fixed |Header| (see header_layout.h) with a single length check,
+   * its fields are then loaded straight from the returned pointer.
+   */
+  template <class Header> char *readHeader() {
+    return consume(Header::kLength);
+  }
+
   void reset();
 
   inline char *buffer() { return buffer_ + pos_; }
@@ -19,6 +19,16 @@ bool DataWriter::writeBytes(void *data, size_t length) {
   return true;
 }
 
+char *DataWriter::reserve(size_t length) {
+  if (length_ + length > capacity_) {
+    return nullptr;
+  }
+
+  char *rv = buffer_ + length_;
+  length_ += length;
+  return rv;
+}
+
 bool DataWriter::writeUInt8(uint8_t value) {
   return writeBytes(&value, sizeof(value));
 }
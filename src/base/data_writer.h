@@ -22,6 +22,14 @@ public:
 
   bool writeBytes(void *data, size_t length);
 
+  // Skip |length| bytes for the caller to fill, nullptr if they do not fit.
+  char *reserve(size_t length);
+
+  // Reserve a fixed |Header| (see header_layout.h) for its fields to be stored.
+  template <class Header> char *writeHeader() {
+    return reserve(Header::kLength);
+  }
+
   inline char *begin() { return buffer_; }
   inline char *end() { return buffer_ + length_; }
   inline size_t bytesWritten() { return length_; }
@@ -0,0 +1,14 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "embedded_alarm.h"
+
+EmbeddedAlarm::EmbeddedAlarm(AlarmFactory *factory)
+    : Alarm(), factory_(factory), node_(this) {}
+
+EmbeddedAlarm::~EmbeddedAlarm() { cancel(); }
+
+void EmbeddedAlarm::setImpl() { factory_->registerAlarm(this); }
+
+void EmbeddedAlarm::cancelImpl() { factory_->unregisterAlarm(this); }
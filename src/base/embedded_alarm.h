@@ -0,0 +1,50 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_EMBEDDED_ALARM_H
+#define SRC_BASE_EMBEDDED_ALARM_H
+
+#include "alarm_factory.h"
+#include "timing_wheel.h"
+
+/**
+ * @brief An alarm that lives inline in its owner object.
+ * It carries the timing wheel node itself and is armed through
+ * AlarmFactory::registerAlarm, so creating one allocates nothing.
+ * @see MemberAlarm
+ */
+class EmbeddedAlarm : public Alarm {
+public:
+  explicit EmbeddedAlarm(AlarmFactory *factory);
+  ~EmbeddedAlarm() override;
+
+  inline TimingWheel::Node *node() { return &node_; }
+
+private:
+  void setImpl() override;
+  void cancelImpl() override;
+
+  AlarmFactory *factory_;
+  TimingWheel::Node node_;
+};
+
+/**
+ * @brief An EmbeddedAlarm calling |Action| of its owner when it fires.
+ * The call is resolved at compile time, e.g.
+ * MemberAlarm<SendBuffer, &SendBuffer::retransmit> replaces a
+ * DEFINE_ALARM_DELEGATE delegate and an AlarmFactory::createAlarm call.
+ */
+template <class Owner, void (Owner::*Action)()>
+class MemberAlarm final : public EmbeddedAlarm {
+public:
+  MemberAlarm(AlarmFactory *factory, Owner *owner)
+      : EmbeddedAlarm(factory), owner_(owner) {}
+
+private:
+  void onAlarm() override { (owner_->*Action)(); }
+
+  Owner *owner_;
+};
+
+#endif // SRC_BASE_EMBEDDED_ALARM_H
@@ -0,0 +1,51 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "embedded_alarm.h"
+#include "../util/mock_alarm_factory.h"
+#include "gtest/gtest.h"
+
+class EmbeddedAlarmTest : public testing::Test {
+protected:
+  class Owner {
+  public:
+    explicit Owner(AlarmFactory *factory) : fired(0), alarm(factory, this) {}
+
+    void onTimeout() { fired++; }
+
+    int fired;
+    MemberAlarm<Owner, &Owner::onTimeout> alarm;
+  };
+
+  MockAlarmFactory factory_;
+};
+
+TEST_F(EmbeddedAlarmTest, Fire) {
+  Owner owner(&factory_);
+  owner.alarm.set(factory_.now() + TimeBase::Delta::fromMilliseconds(10));
+  factory_.elapse(TimeBase::Delta::fromMilliseconds(9));
+  EXPECT_EQ(owner.fired, 0);
+  factory_.elapse(TimeBase::Delta::fromMilliseconds(1));
+  EXPECT_EQ(owner.fired, 1);
+  EXPECT_FALSE(owner.alarm.isSet());
+}
+
+TEST_F(EmbeddedAlarmTest, Update) {
+  Owner owner(&factory_);
+  owner.alarm.set(factory_.now() + TimeBase::Delta::fromMilliseconds(10));
+  owner.alarm.update(factory_.now() + TimeBase::Delta::fromMilliseconds(20));
+  factory_.elapse(TimeBase::Delta::fromMilliseconds(10));
+  EXPECT_EQ(owner.fired, 0);
+  factory_.elapse(TimeBase::Delta::fromMilliseconds(10));
+  EXPECT_EQ(owner.fired, 1);
+}
+
+TEST_F(EmbeddedAlarmTest, CancelOnDestruction) {
+  {
+    Owner owner(&factory_);
+    owner.alarm.set(factory_.now() + TimeBase::Delta::fromMilliseconds(10));
+  }
+  // the destroyed alarm must not fire
+  factory_.elapse(TimeBase::Delta::fromMilliseconds(20));
+}
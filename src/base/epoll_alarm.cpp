@@ -6,10 +6,10 @@
 
 EpollAlarm::EpollAlarm(EpollServer *epoll_server,
                        std::unique_ptr<Delegate> delegate)
-    : Alarm(std::move(delegate)), server_(epoll_server) {}
+    : Alarm(std::move(delegate)), server_(epoll_server), node_(this) {}
 
-void EpollAlarm::setImpl() { token_ = server_->registerAlarm(this); }
+void EpollAlarm::setImpl() { server_->registerAlarm(&node_); }
 
-void EpollAlarm::cancelImpl() { server_->unregisterAlarm(token_); }
+void EpollAlarm::cancelImpl() { server_->unregisterAlarm(&node_); }
 
 EpollAlarm::~EpollAlarm() { cancel(); }
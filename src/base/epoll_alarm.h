@@ -9,7 +9,8 @@
 
 /**
  * @brief EpollAlarm is the alarm correspond to epoll events.
- * All EpollAlarms are managed by EpollServer
+ * All EpollAlarms are managed by EpollServer. Each alarm embeds its own
+ * timing wheel node so that setting and canceling never allocate.
  */
 class EpollAlarm : public Alarm {
 public:
@@ -24,7 +25,7 @@ private:
   void cancelImpl() override;
 
   EpollServer *server_;
-  EpollServer::AlarmToken token_;
+  TimingWheel::Node node_;
 };
 
 #endif // SRC_BASE_EPOLL_ALARM_H
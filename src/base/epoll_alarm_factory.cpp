@@ -3,6 +3,7 @@
 //
 
 #include "epoll_alarm_factory.h"
+#include "embedded_alarm.h"
 #include "epoll_alarm.h"
 #include <glog/logging.h>
 #include <string.h>
@@ -18,3 +19,11 @@ Alarm *
 EpollAlarmFactory::createAlarm(std::unique_ptr<Alarm::Delegate> delegate) {
   return new EpollAlarm(server_, std::move(delegate));
 }
+
+void EpollAlarmFactory::registerAlarm(EmbeddedAlarm *alarm) {
+  server_->registerAlarm(alarm->node());
+}
+
+void EpollAlarmFactory::unregisterAlarm(EmbeddedAlarm *alarm) {
+  server_->unregisterAlarm(alarm->node());
+}
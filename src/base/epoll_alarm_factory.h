@@ -16,6 +16,9 @@ public:
 
   Alarm *createAlarm(std::unique_ptr<Alarm::Delegate> delegate) override;
 
+  void registerAlarm(EmbeddedAlarm *alarm) override;
+  void unregisterAlarm(EmbeddedAlarm *alarm) override;
+
 private:
   EpollServer *server_;
 };
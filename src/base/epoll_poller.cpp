@@ -0,0 +1,126 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "epoll_poller.h"
+#include <climits>
+#include <cstring>
+#include <glog/logging.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "../posix/wrap_function.h"
+
+EpollPoller::EpollPoller()
+    : epfd_(-1), events_(), timer_fd_(-1), timer_deadline_(TimeBase::zero()) {
+  // Since Linux 2.6.8,
+  //       the size argument is ignored, but must be greater than zero;
+  epfd_ = epoll_create(1);
+  if (epfd_ == -1) {
+    LOG(FATAL) << "epoll_create: " << strerror(errno);
+    return;
+  }
+
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timer_fd_ < 0 || !add(timer_fd_)) {
+    LOG(ERROR) << "timerfd_create: " << strerror(errno)
+               << ", fall back to millisecond alarms";
+    timer_fd_ = -1;
+  }
+}
+
+EpollPoller::~EpollPoller() {
+  if (timer_fd_ >= 0) {
+    __real_close(timer_fd_);
+  }
+  if (epfd_ >= 0) {
+    __real_close(epfd_);
+  }
+}
+
+bool EpollPoller::add(int fd) {
+  struct epoll_event event = {};
+  event.events = EPOLLIN | EPOLLERR;
+  event.data.fd = fd;
+  int rv;
+  rv = epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &event);
+  if (rv < 0) {
+    LOG(ERROR) << strerror(errno);
+    return false;
+  }
+
+  return true;
+}
+
+int EpollPoller::wait(TimeBase now, TimeBase::Delta wait, int *fds, int max) {
+  int rv;
+
+  rv = epoll_wait(epfd_, events_, max < events_size_ ? max : events_size_,
+                  waitTimeout(now, wait));
+  if (rv < 0) {
+    if (errno == EINTR) {
+      return 0;
+    }
+    LOG(ERROR) << "epoll_wait: " << strerror(errno);
+    return -1;
+  }
+
+  int count = 0;
+  for (int i = 0; i < rv; i++) {
+    int fd = events_[i].data.fd;
+    if (events_[i].events & EPOLLERR) {
+      DLOG(INFO) << "fd: " << fd << " error";
+    }
+
+    if (fd == timer_fd_) {
+      drainTimer();
+      continue;
+    }
+    fds[count++] = fd;
+  }
+  return count;
+}
+
+/**
+ * @brief Convert |wait| into an epoll_wait timeout.
+ * epoll_wait only has millisecond resolution. A wait with a sub-millisecond
+ * part arms |timer_fd_| instead so that alarms fire neither early (busy
+ * spinning with timeout 0) nor late (rounding down).
+ *
+ * @return timeout in milliseconds, -1 to block until an event arrives
+ */
+int EpollPoller::waitTimeout(TimeBase now, TimeBase::Delta wait) {
+  if (wait <= TimeBase::Delta::zero()) {
+    return 0;
+  }
+  if (wait.isInfinite()) {
+    return -1;
+  }
+
+  int64_t us = wait.toMicroseconds();
+  if (us % 1000 == 0 || timer_fd_ < 0) {
+    // round up so that we never spin before the deadline
+    return (int)std::min<int64_t>((us + 999) / 1000, INT_MAX);
+  }
+
+  TimeBase deadline = now + wait;
+  if (deadline != timer_deadline_) {
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = us / 1000000;
+    spec.it_value.tv_nsec = us % 1000000 * 1000;
+    if (timerfd_settime(timer_fd_, 0, &spec, nullptr) < 0) {
+      LOG(ERROR) << "timerfd_settime: " << strerror(errno);
+      return (int)std::min<int64_t>((us + 999) / 1000, INT_MAX);
+    }
+    timer_deadline_ = deadline;
+  }
+  return -1;
+}
+
+void EpollPoller::drainTimer() {
+  uint64_t expirations;
+  while (__real_read(timer_fd_, &expirations, sizeof(expirations)) > 0) {
+  }
+  timer_deadline_ = TimeBase::zero();
+}
@@ -0,0 +1,37 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_EPOLL_POLLER_H
+#define SRC_BASE_EPOLL_POLLER_H
+
+#include "poller.h"
+#include <sys/epoll.h>
+
+/**
+ * @brief Poller built on epoll_wait.
+ * epoll_wait only has millisecond resolution, so waits with a sub-millisecond
+ * part are measured by a timerfd.
+ */
+class EpollPoller : public Poller {
+public:
+  EpollPoller();
+  ~EpollPoller() override;
+
+  bool add(int fd) override;
+  int wait(TimeBase now, TimeBase::Delta wait, int *fds, int max) override;
+
+private:
+  int waitTimeout(TimeBase now, TimeBase::Delta wait);
+  void drainTimer();
+
+  int epfd_;
+  static const int events_size_ = 256;
+  struct epoll_event events_[256];
+
+  // timerfd for waits that epoll_wait cannot express in milliseconds
+  int timer_fd_;
+  TimeBase timer_deadline_;
+};
+
+#endif // SRC_BASE_EPOLL_POLLER_H
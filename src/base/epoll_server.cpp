@@ -5,19 +5,39 @@
 #include "epoll_server.h"
 #include <cstring>
 #include <glog/logging.h>
-#include <sys/time.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
 
-EpollServer::EpollServer() : epfd_(-1), cb_map_(), events_(), now_(0) {
+#include "../posix/wrap_function.h"
 
-  // Since Linux 2.6.8,
-  //       the size argument is ignored, but must be greater than zero;
-  epfd_ = epoll_create(1);
-  if (epfd_ == -1) {
-    LOG(FATAL) << "epoll_create: " << strerror(errno);
+EpollServer::EpollServer(ClockType clock_type, PollerType poller_type)
+    : poller_(Poller::create(poller_type)), cb_map_(), ready_(),
+      event_fd_(-1), task_callback_(this), tasks_(), iteration_hooks_(),
+      wakeup_pending_(false), loop_thread_(),
+      clock_(Clock::create(clock_type)), stats_(),
+      stats_enabled_(true), busy_budget_(TimeBase::Delta::zero()),
+      busy_max_budget_(TimeBase::Delta::zero()),
+      busy_cap_(TimeBase::Delta::zero()), busy_window_start_(0),
+      busy_window_spin_(TimeBase::Delta::zero()), now_(0),
+      timing_wheel_(TimeBase::zero()) {
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ < 0 || !registerRead(event_fd_, &task_callback_)) {
+    LOG(FATAL) << "eventfd: " << strerror(errno);
     return;
   }
 
   updateNow();
+  timing_wheel_.advance(now_);
+}
+
+/**
+ * @brief Close the eventfd of posted tasks. The poller closes its epoll fd
+ * and timerfd (or its ring) when it is destroyed right after.
+ */
+EpollServer::~EpollServer() {
+  if (event_fd_ >= 0) {
+    __real_close(event_fd_);
+  }
 }
 
 /**
@@ -34,18 +54,10 @@ bool EpollServer::registerRead(int fd, EpollCallback *cb) {
     return true;
   }
 
-  cb_map_[fd] = cb;
-
-  struct epoll_event event = {};
-  event.events = EPOLLIN | EPOLLERR;
-  event.data.fd = fd;
-  int rv;
-  rv = epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &event);
-  if (rv < 0) {
-    LOG(ERROR) << strerror(errno);
+  if (!poller_->add(fd)) {
     return false;
   }
-
+  cb_map_[fd] = cb;
   return true;
 }
 
@@ -55,75 +67,239 @@ bool EpollServer::registerRead(int fd, EpollCallback *cb) {
  * and then fires all alarms whose deadline is elapsed.
  */
 bool EpollServer::runEventLoop(TimeBase::Delta wait) {
+  loop_thread_.store(std::this_thread::get_id(), std::memory_order_relaxed);
   bool rv = false;
   updateNow();
   rv |= runReadEvent(std::min(wait, incomingAlarm()));
+  const TimeBase woken = now();
   rv |= runAlarmEvent();
+  for (const Task &hook : iteration_hooks_) {
+    hook();
+  }
+  if (stats_enabled_) {
+    stats_.iteration.record((clock_->now() - woken).toMicroseconds());
+  }
   return rv;
 }
 
 bool EpollServer::runReadEvent(const TimeBase::Delta &wait) {
   int rv;
 
-  rv = epoll_wait(epfd_, events_, events_size_, wait.toMilliseconds());
+  const TimeBase wait_start = now();
+  TimeBase::Delta left = wait;
+  rv = busyPoll(&left);
+  if (rv == 0) {
+    rv = poller_->wait(now(), left, ready_, events_size_);
+  }
   if (rv < 0) {
-    LOG(FATAL) << "epoll_wait failed";
+    LOG(FATAL) << "poller wait failed";
     return false;
   }
+  // alarms that expired during the wait fire in this iteration
+  updateNow();
+  if (!busy_budget_.isZero() && wait > TimeBase::Delta::zero()) {
+    adaptBusyPoll(rv > 0 ? now() - wait_start : TimeBase::Delta::infinite());
+  }
+  if (stats_enabled_) {
+    stats_.events.record(rv);
+  }
 
   if (rv == 0) {
     return false;
   }
 
+  TimeBase start = now();
   for (int i = 0; i < rv; i++) {
-    int fd = events_[i].data.fd;
-    if (events_[i].events & EPOLLERR) {
-      DLOG(INFO) << "fd: " << fd << " error";
-    }
-
-    auto iter = cb_map_.find(fd);
+    auto iter = cb_map_.find(ready_[i]);
     if (iter != cb_map_.end()) {
       iter->second->onReadable();
+      if (stats_enabled_) {
+        TimeBase end = clock_->now();
+        stats_.callback.record((end - start).toMicroseconds());
+        start = end;
+      }
     }
   }
   return true;
 }
 
-EpollServer::AlarmToken EpollServer::registerAlarm(Alarm *alarm) {
-  return alarm_map_.emplace(alarm->deadline(), alarm);
+void EpollServer::addIterationHook(Task hook) {
+  iteration_hooks_.push_back(std::move(hook));
+}
+
+void EpollServer::post(Task task) {
+  tasks_.push(std::move(task));
+  if (!wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+    // the loop drains the whole queue, so one wakeup per batch is enough
+    uint64_t one = 1;
+    if (__real_write(event_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+      LOG(ERROR) << "eventfd write: " << strerror(errno);
+    }
+  }
+}
+
+void EpollServer::runInLoop(Task task) {
+  if (isInLoopThread()) {
+    task();
+    return;
+  }
+  post(std::move(task));
 }
 
-void EpollServer::unregisterAlarm(AlarmToken token) { alarm_map_.erase(token); }
+bool EpollServer::isInLoopThread() const {
+  return loop_thread_.load(std::memory_order_relaxed) ==
+         std::this_thread::get_id();
+}
 
+void EpollServer::TaskCallback::onReadable() {
+  uint64_t count;
+  while (__real_read(server_->event_fd_, &count, sizeof(count)) > 0) {
+  }
+  server_->runTasks();
+}
+
+/**
+ * @brief Run all posted tasks.
+ * Clearing |wakeup_pending_| first makes every task pushed before it
+ * visible here, and a task pushed after it writes |event_fd_| again.
+ */
+void EpollServer::runTasks() {
+  wakeup_pending_.exchange(false, std::memory_order_acq_rel);
+  Task task;
+  while (tasks_.pop(&task)) {
+    task();
+  }
+}
+
+void EpollServer::registerAlarm(AlarmToken token) {
+  timing_wheel_.schedule(token, token->alarm()->deadline());
+}
+
+void EpollServer::unregisterAlarm(AlarmToken token) {
+  timing_wheel_.cancel(token);
+}
+
+/**
+ * @brief Fire all alarms whose deadline is elapsed.
+ * The timing wheel collects them in one batch. An alarm canceled by an
+ * earlier callback in the batch is unlinked and never fires.
+ */
 bool EpollServer::runAlarmEvent() {
-  while (!alarm_map_.empty() && now() >= alarm_map_.begin()->first) {
-    auto alarm = alarm_map_.begin();
-    alarm->second->fire();
-    alarm_map_.erase(alarm);
+  timing_wheel_.advance(now());
+  bool rv = false;
+  TimingWheel::Node *node;
+  while ((node = timing_wheel_.popExpired()) != nullptr) {
+    if (stats_enabled_) {
+      stats_.alarm_lateness.record(
+          (now() - node->alarm()->deadline()).toMicroseconds());
+    }
+    node->alarm()->fire();
+    rv = true;
   }
-  return false;
+  return rv;
 }
 
-void EpollServer::updateNow() {
-  timeval time{};
-  int rv = gettimeofday(&time, nullptr);
-  if (rv < 0) {
-    LOG(FATAL) << "gettimeofday: " << strerror(errno);
-    return;
+void EpollServer::updateNow() { now_ = clock_->now(); }
+
+void EpollServer::setStatsEnabled(bool enabled) { stats_enabled_ = enabled; }
+
+void EpollServer::enableBusyPoll(TimeBase::Delta max_budget, double cpu_cap) {
+  runInLoop([this, max_budget, cpu_cap] {
+    busy_max_budget_ = max_budget;
+    busy_budget_ = max_budget;
+    busy_cap_ = busyPollWindow() * std::max(0.0, std::min(cpu_cap, 1.0));
+    busy_window_start_ = now();
+    busy_window_spin_ = TimeBase::Delta::zero();
+  });
+}
+
+/**
+ * @brief Spin with non-blocking polls for up to the current budget.
+ * Packets that arrive during the spin are handled without the wakeup and the
+ * context switch of a blocking wait.
+ *
+ * @param wait reduced by the time spent spinning
+ * @return the number of readable file descriptors, 0 if none arrived in the
+ * budget, -1 on failure
+ */
+int EpollServer::busyPoll(TimeBase::Delta *wait) {
+  if (busy_budget_.isZero() || *wait <= TimeBase::Delta::zero()) {
+    return 0;
   }
 
-  int64_t t = time.tv_usec / 1000;
-  t += time.tv_sec * 1000 * 1000;
-  now_ = TimeBase(t);
+  const TimeBase start = now();
+  if (start - busy_window_start_ >= busyPollWindow()) {
+    busy_window_start_ = start;
+    busy_window_spin_ = TimeBase::Delta::zero();
+  }
+  if (busy_window_spin_ >= busy_cap_) {
+    stats_.busy_poll_capped++;
+    return 0;
+  }
+
+  TimeBase::Delta budget = std::min(busy_budget_, *wait);
+  budget = std::min(budget, busy_cap_ - busy_window_spin_);
+  const TimeBase deadline = start + budget;
+  int rv;
+  do {
+    rv = poller_->wait(now(), TimeBase::Delta::zero(), ready_, events_size_);
+    updateNow();
+  } while (rv == 0 && now() < deadline);
+
+  const TimeBase::Delta spent = now() - start;
+  busy_window_spin_ = busy_window_spin_ + spent;
+  if (!wait->isInfinite()) {
+    *wait = *wait - spent;
+  }
+  stats_.busy_polls++;
+  stats_.busy_poll_us += spent.toMicroseconds();
+  if (rv > 0) {
+    stats_.busy_poll_hits++;
+  }
+  return rv;
+}
+
+/**
+ * @brief Grow the spin budget if events arrived within |busy_max_budget_|,
+ * since a longer spin would have caught them, and shrink it otherwise.
+ *
+ * @param idle time from the start of the wait to the first event
+ */
+void EpollServer::adaptBusyPoll(const TimeBase::Delta &idle) {
+  if (idle <= busy_max_budget_) {
+    busy_budget_ = std::min(busy_budget_ * 2, busy_max_budget_);
+  } else {
+    busy_budget_ = std::max(busy_budget_ >> 1, minBusyPollBudget());
+  }
+}
+
+void EpollServer::Stats::reset() {
+  iteration.reset();
+  events.reset();
+  alarm_lateness.reset();
+  callback.reset();
+  busy_polls = 0;
+  busy_poll_hits = 0;
+  busy_poll_capped = 0;
+  busy_poll_us = 0;
+}
+
+void EpollServer::Stats::dump(std::ostream &os) const {
+  os << "iteration(us): ";
+  iteration.dump(os);
+  os << "\nevents per wait: ";
+  events.dump(os);
+  os << "\nalarm lateness(us): ";
+  alarm_lateness.dump(os);
+  os << "\ncallback(us): ";
+  callback.dump(os);
+  os << "\nbusy polls: " << busy_polls << " hits=" << busy_poll_hits
+     << " capped=" << busy_poll_capped << " spin(us)=" << busy_poll_us;
+  os << "\n";
 }
 
 const TimeBase &EpollServer::now() const { return now_; }
 
 TimeBase::Delta EpollServer::incomingAlarm() {
-  TimeBase incoming = alarm_map_.begin()->first;
-  TimeBase::Delta rv = incoming - now();
-  if (rv < TimeBase::Delta::zero()) {
-    return TimeBase::Delta::zero();
-  }
-  return rv;
+  return timing_wheel_.nextTimeout(now());
 }
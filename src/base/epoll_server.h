@@ -6,11 +6,19 @@
 #define SRC_BASE_EPOLL_SERVER_H
 
 #include "alarm_factory.h"
+#include "clock.h"
+#include "histogram.h"
+#include "mpsc_queue.h"
+#include "poller.h"
 #include "time_base.h"
+#include "timing_wheel.h"
 #include "util.h"
-#include <map>
-#include <sys/epoll.h>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 /**
  * @brief Epoll IO callback for handing packets to upper layers.
@@ -33,33 +41,162 @@ public:
 class EpollServer {
 public:
   DISALLOW_COPY_AND_ASSIGN(EpollServer)
-  EpollServer();
+  explicit EpollServer(ClockType clock_type = ClockType::MONOTONIC,
+                       PollerType poller_type = PollerType::EPOLL);
+  ~EpollServer();
 
   bool registerRead(int fd, EpollCallback *cb);
   bool runEventLoop(TimeBase::Delta wait);
 
-  typedef std::multimap<TimeBase, Alarm *> AlarmMap;
-  typedef AlarmMap::iterator AlarmToken;
+  // The wheel node embedded in an EpollAlarm
+  typedef TimingWheel::Node *AlarmToken;
 
-  AlarmToken registerAlarm(Alarm *alarm);
+  void registerAlarm(AlarmToken token);
   void unregisterAlarm(AlarmToken token);
 
+  /**
+   * @brief The time cached at the beginning of the current loop iteration
+   * and refreshed once the wait for events returns. All layers read it
+   * through AlarmFactory::now() instead of reading the clock.
+   */
   const TimeBase &now() const;
 
+  typedef std::function<void()> Task;
+
+  /**
+   * @brief Run |task| in the loop thread during the next iteration.
+   * It is safe to call from any thread and wakes up a blocking loop.
+   */
+  void post(Task task);
+
+  // Run |task| at once in the loop thread, post it from other threads.
+  void runInLoop(Task task);
+
+  /**
+   * @brief Run |func| in the loop thread and wait for its result.
+   * Never call it from another loop while holding a lock that this loop may
+   * take, or the two threads deadlock.
+   */
+  template <class Func> auto runInLoopAndWait(Func func) -> decltype(func()) {
+    if (isInLoopThread()) {
+      return func();
+    }
+    std::packaged_task<decltype(func())()> task(std::move(func));
+    auto result = task.get_future();
+    // |task| outlives the posted closure since we wait for it below
+    post([&task] { task(); });
+    return result.get();
+  }
+
+  bool isInLoopThread() const;
+
+  /**
+   * @brief Run |hook| at the end of every iteration, after the callbacks and
+   * alarms, e.g. to flush the frames they queued with one syscall.
+   * Add hooks in the loop thread or before the loop starts.
+   */
+  void addIterationHook(Task hook);
+
+  /**
+   * @brief Histograms of the loop, durations are in microseconds.
+   * Only the loop thread updates them, so read them in the loop thread,
+   * e.g. with runInLoopAndWait.
+   */
+  struct Stats {
+    // time spent on callbacks and alarms in one iteration, without the wait
+    Histogram iteration;
+    // readable file descriptors returned by one wait
+    Histogram events;
+    // delay from the deadline of an alarm to its firing
+    Histogram alarm_lateness;
+    // duration of one EpollCallback::onReadable
+    Histogram callback;
+
+    // busy polling counters, @see enableBusyPoll
+    uint64_t busy_polls = 0;
+    // busy polls that found a readable file descriptor
+    uint64_t busy_poll_hits = 0;
+    // busy polls skipped because of the CPU cap
+    uint64_t busy_poll_capped = 0;
+    uint64_t busy_poll_us = 0;
+
+    void reset();
+    void dump(std::ostream &os) const;
+  };
+
+  inline const Stats &stats() const { return stats_; }
+  inline Stats &stats() { return stats_; }
+
+  // Recording is on by default, it costs one clock read per callback.
+  void setStatsEnabled(bool enabled);
+
+  /**
+   * @brief Spin on non-blocking polls before blocking in the poller.
+   * The spin budget of an iteration adapts to the traffic like NAPI: it
+   * doubles up to |max_budget| when a spin finds events and halves when it
+   * runs out. Spinning takes at most |cpu_cap| of each second.
+   * It is safe to call from any thread, a zero |max_budget| disables it.
+   */
+  void enableBusyPoll(TimeBase::Delta max_budget, double cpu_cap);
+
 private:
-  int epfd_;
+  /**
+   * @brief Drains |event_fd_| and runs posted tasks.
+   *
+   */
+  class TaskCallback : public EpollCallback {
+  public:
+    explicit TaskCallback(EpollServer *server) : server_(server) {}
+    void onReadable() override;
+
+  private:
+    EpollServer *server_;
+  };
+
+  std::unique_ptr<Poller> poller_;
   std::unordered_map<int, EpollCallback *> cb_map_;
   static const int events_size_ = 256;
-  struct epoll_event events_[256];
-  AlarmMap alarm_map_;
+  int ready_[256];
+
+  // eventfd for tasks posted by other threads
+  int event_fd_;
+  TaskCallback task_callback_;
+  MpscQueue<Task> tasks_;
+  std::vector<Task> iteration_hooks_;
+  // set by the producer that writes |event_fd_|, cleared by the loop
+  std::atomic<bool> wakeup_pending_;
+  std::atomic<std::thread::id> loop_thread_;
+
+  void runTasks();
 
   bool runReadEvent(const TimeBase::Delta &wait);
+  int busyPoll(TimeBase::Delta *wait);
+  void adaptBusyPoll(const TimeBase::Delta &idle);
+
+  static constexpr TimeBase::Delta busyPollWindow() {
+    return TimeBase::Delta::fromSeconds(1);
+  }
+  static constexpr TimeBase::Delta minBusyPollBudget() {
+    return TimeBase::Delta::fromMicroseconds(2);
+  }
   bool runAlarmEvent();
 
   TimeBase::Delta incomingAlarm();
 
   void updateNow();
+  std::unique_ptr<Clock> clock_;
+  Stats stats_;
+  bool stats_enabled_;
+
+  // current adaptive spin budget, zero if busy polling is disabled
+  TimeBase::Delta busy_budget_;
+  TimeBase::Delta busy_max_budget_;
+  // spin time allowed in each |busyPollWindow|
+  TimeBase::Delta busy_cap_;
+  TimeBase busy_window_start_;
+  TimeBase::Delta busy_window_spin_;
   TimeBase now_;
+  TimingWheel timing_wheel_;
 };
 
 #endif // SRC_BASE_EPOLL_SERVER_H
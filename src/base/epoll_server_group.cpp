@@ -0,0 +1,79 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "epoll_server_group.h"
+#include <glog/logging.h>
+
+EpollServerGroup::EpollServerGroup(size_t size, ClockType clock_type,
+                                   PollerType poller_type)
+    : servers_(), alarm_factories_(), threads_(), running_(false), next_(0) {
+  DCHECK(size > 0);
+  for (size_t i = 0; i < size; i++) {
+    servers_.push_back(std::make_unique<EpollServer>(clock_type, poller_type));
+    alarm_factories_.push_back(
+        std::make_unique<EpollAlarmFactory>(servers_.back().get()));
+  }
+}
+
+EpollServerGroup::~EpollServerGroup() { stop(); }
+
+void EpollServerGroup::start() {
+  if (running_.exchange(true)) {
+    return;
+  }
+  for (auto &server : servers_) {
+    threads_.emplace_back(EpollServerGroup::runThread, this, server.get());
+  }
+}
+
+void EpollServerGroup::stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  for (auto &server : servers_) {
+    // wake up the loop so that it notices |running_|
+    server->post([]() {});
+  }
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+void EpollServerGroup::runThread(EpollServerGroup *group,
+                                 EpollServer *server) {
+  while (group->running_.load(std::memory_order_relaxed)) {
+    server->runEventLoop(TimeBase::Delta::fromMilliseconds(1000));
+  }
+}
+
+EpollServer *EpollServerGroup::getServer(size_t index) {
+  DCHECK(index < servers_.size());
+  return servers_[index].get();
+}
+
+AlarmFactory *EpollServerGroup::getAlarmFactory(size_t index) {
+  DCHECK(index < alarm_factories_.size());
+  return alarm_factories_[index].get();
+}
+
+size_t EpollServerGroup::nextIndex() {
+  return next_.fetch_add(1, std::memory_order_relaxed) % servers_.size();
+}
+
+void EpollServerGroup::runInLoop(size_t index, EpollServer::Task task) {
+  getServer(index)->runInLoop(std::move(task));
+}
+
+void EpollServerGroup::dumpStats(std::ostream &os) {
+  for (size_t i = 0; i < servers_.size(); i++) {
+    EpollServer *server = servers_[i].get();
+    os << "event loop " << i << "\n";
+    if (running_.load(std::memory_order_relaxed)) {
+      server->runInLoopAndWait([server, &os] { server->stats().dump(os); });
+    } else {
+      server->stats().dump(os);
+    }
+  }
+}
@@ -0,0 +1,58 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_EPOLL_SERVER_GROUP_H
+#define SRC_BASE_EPOLL_SERVER_GROUP_H
+
+#include "epoll_alarm_factory.h"
+#include "epoll_server.h"
+#include "util.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief EpollServerGroup runs one EpollServer per reactor thread.
+ * A file descriptor registered to a server and an alarm created by the
+ * server's alarm factory are pinned to that server, i.e. their callbacks
+ * always run in its thread. Use |runInLoop| to hand work to another loop.
+ * @see EpollServer::post
+ */
+class EpollServerGroup {
+public:
+  DISALLOW_COPY_AND_ASSIGN(EpollServerGroup)
+  explicit EpollServerGroup(size_t size,
+                            ClockType clock_type = ClockType::MONOTONIC,
+                            PollerType poller_type = PollerType::EPOLL);
+  ~EpollServerGroup();
+
+  // Spawn one thread for each server.
+  void start();
+  // Stop and join all threads.
+  void stop();
+
+  inline size_t size() const { return servers_.size(); }
+
+  EpollServer *getServer(size_t index);
+  AlarmFactory *getAlarmFactory(size_t index);
+
+  // Pick an owning loop for a new fd or session in a round-robin way.
+  size_t nextIndex();
+
+  void runInLoop(size_t index, EpollServer::Task task);
+
+  // Dump the stats of every loop, @see EpollServer::Stats
+  void dumpStats(std::ostream &os);
+
+private:
+  static void runThread(EpollServerGroup *group, EpollServer *server);
+
+  std::vector<std::unique_ptr<EpollServer>> servers_;
+  std::vector<std::unique_ptr<EpollAlarmFactory>> alarm_factories_;
+  std::vector<std::thread> threads_;
+  std::atomic<bool> running_;
+  std::atomic<size_t> next_;
+};
+
+#endif // SRC_BASE_EPOLL_SERVER_GROUP_H
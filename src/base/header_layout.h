@@ -0,0 +1,88 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_HEADER_LAYOUT_H
+#define SRC_BASE_HEADER_LAYOUT_H
+
+#include "util.h"
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Conversion between host and network byte order, usable in constant
+ * expressions and inlined to a single bswap.
+ */
+struct ByteOrder {
+  static constexpr uint8_t swap(uint8_t value) { return value; }
+
+  static constexpr uint16_t swap(uint16_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return value;
+#else
+    return __builtin_bswap16(value);
+#endif
+  }
+
+  static constexpr uint32_t swap(uint32_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return value;
+#else
+    return __builtin_bswap32(value);
+#endif
+  }
+
+  static constexpr uint64_t swap(uint64_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return value;
+#else
+    return __builtin_bswap64(value);
+#endif
+  }
+};
+
+/**
+ * @brief An unsigned integer at |Offset| of a header, stored in network byte
+ * order. The header must have been bounds checked as a whole, so |load| and
+ * |store| compile to a plain (possibly unaligned) move and a bswap.
+ */
+template <class T, size_t Offset> struct HeaderField {
+  static_assert(std::is_unsigned<T>::value, "fields are unsigned integers");
+
+  static constexpr size_t kOffset = Offset;
+  static constexpr size_t kEnd = Offset + sizeof(T);
+
+  static inline T load(const char *header) {
+    T value;
+    memcpy(&value, header + Offset, sizeof(T));
+    return ByteOrder::swap(value);
+  }
+
+  static inline void store(char *header, T value) {
+    value = ByteOrder::swap(value);
+    memcpy(header + Offset, &value, sizeof(T));
+  }
+};
+
+/**
+ * @brief A field copied as it is, e.g. an address which is kept in network
+ * byte order by its wrapper.
+ */
+template <class T, size_t Offset> struct RawHeaderField {
+  static_assert(std::is_trivially_copyable<T>::value, "fields are plain data");
+
+  static constexpr size_t kOffset = Offset;
+  static constexpr size_t kEnd = Offset + sizeof(T);
+
+  static inline T load(const char *header) {
+    T value;
+    memcpy(&value, header + Offset, sizeof(T));
+    return value;
+  }
+
+  static inline void store(char *header, const T &value) {
+    memcpy(header + Offset, &value, sizeof(T));
+  }
+};
+
+#endif // SRC_BASE_HEADER_LAYOUT_H
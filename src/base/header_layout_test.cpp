@@ -0,0 +1,72 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "header_layout.h"
+#include "data_reader.h"
+#include "data_writer.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+struct TestHeader {
+  static constexpr size_t kLength = 8;
+
+  typedef HeaderField<uint8_t, 0> Byte;
+  typedef HeaderField<uint16_t, 1> Word;
+  typedef HeaderField<uint32_t, 3> Long;
+  typedef RawHeaderField<char, 7> Raw;
+};
+
+} // namespace
+
+TEST(HeaderLayoutTest, ByteOrder) {
+  uint64_t value = ByteOrder::swap(uint64_t(0x0102030405060708));
+  const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+  for (int i = 0; i < 8; i++) {
+    // the most significant byte comes first
+    EXPECT_EQ(bytes[i], i + 1);
+  }
+  static_assert(ByteOrder::swap(ByteOrder::swap(uint16_t(0x1234))) == 0x1234,
+                "swap is constexpr");
+}
+
+TEST(HeaderLayoutTest, WriteAndRead) {
+  const size_t length = TestHeader::kLength;
+  char buf[10];
+  DataWriter writer(buf, sizeof(buf));
+  char *header = writer.writeHeader<TestHeader>();
+  ASSERT_NE(header, nullptr);
+  TestHeader::Byte::store(header, 0xab);
+  TestHeader::Word::store(header, 0x1234);
+  TestHeader::Long::store(header, 0x12345678);
+  TestHeader::Raw::store(header, 'x');
+  EXPECT_EQ(writer.writeHeader<TestHeader>(), nullptr);
+  EXPECT_EQ(writer.bytesWritten(), length);
+
+  // same as the per-field reader
+  DataReader fields(buf, sizeof(buf));
+  uint8_t byte;
+  uint16_t word;
+  uint32_t value;
+  EXPECT_TRUE(fields.readUInt8(&byte));
+  EXPECT_TRUE(fields.readUInt16(&word));
+  EXPECT_TRUE(fields.readUInt32(&value));
+  EXPECT_EQ(byte, 0xab);
+  EXPECT_EQ(word, 0x1234);
+  EXPECT_EQ(value, 0x12345678);
+
+  DataReader reader(buf, length);
+  const char *parsed = reader.readHeader<TestHeader>();
+  ASSERT_EQ(parsed, buf);
+  EXPECT_EQ(reader.length(), 0);
+  EXPECT_EQ(TestHeader::Byte::load(parsed), 0xab);
+  EXPECT_EQ(TestHeader::Word::load(parsed), 0x1234);
+  EXPECT_EQ(TestHeader::Long::load(parsed), 0x12345678);
+  EXPECT_EQ(TestHeader::Raw::load(parsed), 'x');
+
+  // one length check for the whole header
+  DataReader truncated(buf, length - 1);
+  EXPECT_EQ(truncated.readHeader<TestHeader>(), nullptr);
+  EXPECT_EQ(truncated.length(), length - 1);
+}
@@ -0,0 +1,83 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "histogram.h"
+#include <algorithm>
+#include <cstring>
+
+Histogram::Histogram() { reset(); }
+
+void Histogram::reset() {
+  count_ = 0;
+  sum_ = 0;
+  min_ = UINT64_MAX;
+  max_ = 0;
+  memset(buckets_, 0, sizeof(buckets_));
+}
+
+/**
+ * @brief Values in [2^k, 2^(k+1)) with k >= |kSubBucketBits| share the
+ * group k - |kSubBucketBits| + 1, and are split into |kSubBuckets| buckets by
+ * the bits following the leading one.
+ */
+int Histogram::bucketIndex(uint64_t value) {
+  if (value < static_cast<uint64_t>(kSubBuckets)) {
+    return static_cast<int>(value);
+  }
+  const int shift = 63 - __builtin_clzll(value) - kSubBucketBits;
+  const int sub = static_cast<int>(value >> shift) - kSubBuckets;
+  return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t Histogram::bucketUpperBound(int index) {
+  if (index < kSubBuckets) {
+    return static_cast<uint64_t>(index);
+  }
+  const int shift = index / kSubBuckets - 1;
+  const uint64_t top = kSubBuckets + index % kSubBuckets;
+  // the last bucket ends at UINT64_MAX, where (top + 1) << shift wraps to 0
+  return ((top + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+  buckets_[bucketIndex(value)]++;
+  count_++;
+  sum_ += value;
+  if (value < min_) {
+    min_ = value;
+  }
+  if (value > max_) {
+    max_ = value;
+  }
+}
+
+double Histogram::mean() const {
+  return count_ == 0 ? 0 : static_cast<double>(sum_) / count_;
+}
+
+uint64_t Histogram::percentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(percentile / 100 * count_ + 0.5);
+  if (rank < 1) {
+    rank = 1;
+  }
+
+  uint64_t seen = 0;
+  for (int i = 0; i < kBuckets; i++) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return std::min(bucketUpperBound(i), max_);
+    }
+  }
+  return max_;
+}
+
+void Histogram::dump(std::ostream &os) const {
+  os << "count=" << count_ << " mean=" << mean() << " min=" << min()
+     << " p50=" << percentile(50) << " p90=" << percentile(90)
+     << " p99=" << percentile(99) << " p99.9=" << percentile(99.9)
+     << " max=" << max_;
+}
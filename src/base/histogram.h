@@ -0,0 +1,57 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_HISTOGRAM_H
+#define SRC_BASE_HISTOGRAM_H
+
+#include "util.h"
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief A log-linear (HDR style) histogram of non-negative integers.
+ * Values below |kSubBuckets| are counted exactly. Larger values fall into
+ * one of |kSubBuckets| buckets per power of two, i.e. percentiles have a
+ * relative error below 1 / |kSubBuckets|.
+ *
+ * Recording is a bit scan and an increment, without allocation or locking.
+ * A histogram is not thread-safe.
+ */
+class Histogram {
+public:
+  Histogram();
+
+  void record(uint64_t value);
+  void reset();
+
+  inline uint64_t count() const { return count_; }
+  inline uint64_t min() const { return count_ == 0 ? 0 : min_; }
+  inline uint64_t max() const { return max_; }
+  double mean() const;
+
+  /**
+   * @brief The highest value equivalent to the value at |percentile|, e.g.
+   * percentile(99) is not less than 99% of all recorded values.
+   */
+  uint64_t percentile(double percentile) const;
+
+  // Print count, mean, percentiles and max in one line.
+  void dump(std::ostream &os) const;
+
+  static const int kSubBucketBits = 4;
+  static const int kSubBuckets = 1 << kSubBucketBits;
+  static const int kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+private:
+  static int bucketIndex(uint64_t value);
+  static uint64_t bucketUpperBound(int index);
+
+  uint64_t count_;
+  uint64_t sum_;
+  uint64_t min_;
+  uint64_t max_;
+  uint64_t buckets_[kBuckets];
+};
+
+#endif // SRC_BASE_HISTOGRAM_H
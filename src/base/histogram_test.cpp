@@ -0,0 +1,59 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "histogram.h"
+#include "gtest/gtest.h"
+#include <sstream>
+
+TEST(HistogramTest, Empty) {
+  Histogram histogram;
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.max(), 0);
+  EXPECT_EQ(histogram.percentile(99), 0);
+}
+
+TEST(HistogramTest, SmallValuesAreExact) {
+  Histogram histogram;
+  for (uint64_t i = 1; i <= 10; i++) {
+    histogram.record(i);
+  }
+  EXPECT_EQ(histogram.count(), 10);
+  EXPECT_EQ(histogram.min(), 1);
+  EXPECT_EQ(histogram.max(), 10);
+  EXPECT_DOUBLE_EQ(histogram.mean(), 5.5);
+  EXPECT_EQ(histogram.percentile(50), 5);
+  EXPECT_EQ(histogram.percentile(90), 9);
+  EXPECT_EQ(histogram.percentile(100), 10);
+}
+
+TEST(HistogramTest, RelativeError) {
+  Histogram histogram;
+  for (uint64_t i = 1; i <= 100000; i++) {
+    histogram.record(i);
+  }
+  const double kError = 1.0 / Histogram::kSubBuckets;
+  for (double p : {50.0, 90.0, 99.0, 99.9}) {
+    auto exact = static_cast<double>(p * 1000);
+    EXPECT_GE(histogram.percentile(p), exact);
+    EXPECT_LE(histogram.percentile(p), exact * (1 + kError));
+  }
+  EXPECT_EQ(histogram.percentile(100), 100000);
+}
+
+TEST(HistogramTest, Extremes) {
+  Histogram histogram;
+  histogram.record(0);
+  histogram.record(UINT64_MAX);
+  EXPECT_EQ(histogram.percentile(50), 0);
+  EXPECT_EQ(histogram.percentile(100), UINT64_MAX);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.count(), 0);
+  histogram.record(1000);
+  std::stringstream ss;
+  histogram.dump(ss);
+  EXPECT_EQ(ss.str(), "count=1 mean=1000 min=1000 p50=1000 p90=1000 "
+                      "p99=1000 p99.9=1000 max=1000");
+}
@@ -0,0 +1,237 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "io_uring_poller.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <glog/logging.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../posix/wrap_function.h"
+
+namespace {
+
+int ioUringSetup(unsigned int entries, struct io_uring_params *params) {
+  return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+int ioUringEnter(int fd, unsigned int to_submit, unsigned int min_complete,
+                 unsigned int flags) {
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                      nullptr, 0);
+}
+
+template <class T> inline T *ringField(void *ring, uint32_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+
+} // namespace
+
+IoUringPoller::IoUringPoller()
+    : ring_fd_(-1), sq_ring_(MAP_FAILED), sq_ring_size_(0), sq_head_(nullptr),
+      sq_tail_(nullptr), sq_mask_(nullptr), sq_array_(nullptr),
+      sqes_(static_cast<io_uring_sqe *>(MAP_FAILED)), sqes_size_(0),
+      sq_local_tail_(0), to_submit_(0), cq_ring_(MAP_FAILED),
+      cq_ring_size_(0), cq_head_(nullptr), cq_tail_(nullptr),
+      cq_mask_(nullptr), cqes_(nullptr), timeout_() {
+  struct io_uring_params params = {};
+  int fd = ioUringSetup(kEntries, &params);
+  if (fd < 0) {
+    LOG(ERROR) << "io_uring_setup: " << strerror(errno);
+    return;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    LOG(ERROR) << "mmap sq ring: " << strerror(errno);
+    __real_close(fd);
+    return;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      LOG(ERROR) << "mmap cq ring: " << strerror(errno);
+      __real_close(fd);
+      return;
+    }
+  }
+
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = static_cast<io_uring_sqe *>(
+      mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+  if (sqes_ == MAP_FAILED) {
+    LOG(ERROR) << "mmap sqes: " << strerror(errno);
+    __real_close(fd);
+    return;
+  }
+
+  sq_head_ = ringField<unsigned int>(sq_ring_, params.sq_off.head);
+  sq_tail_ = ringField<unsigned int>(sq_ring_, params.sq_off.tail);
+  sq_mask_ = ringField<unsigned int>(sq_ring_, params.sq_off.ring_mask);
+  sq_array_ = ringField<unsigned int>(sq_ring_, params.sq_off.array);
+  sq_local_tail_ = *sq_tail_;
+  cq_head_ = ringField<unsigned int>(cq_ring_, params.cq_off.head);
+  cq_tail_ = ringField<unsigned int>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = ringField<unsigned int>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = ringField<struct io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+
+  ring_fd_ = fd;
+}
+
+IoUringPoller::~IoUringPoller() {
+  if (sqes_ != MAP_FAILED) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != MAP_FAILED) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    __real_close(ring_fd_);
+  }
+}
+
+/**
+ * @brief Get a free submission entry. If the ring is full, submit the
+ * queued entries first.
+ */
+struct io_uring_sqe *IoUringPoller::getSqe() {
+  unsigned int head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (sq_local_tail_ - head >= kEntries) {
+    if (enter(0) < 0) {
+      return nullptr;
+    }
+    head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ - head >= kEntries) {
+      return nullptr;
+    }
+  }
+
+  unsigned int index = sq_local_tail_ & *sq_mask_;
+  struct io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  sq_local_tail_++;
+  to_submit_++;
+  return sqe;
+}
+
+void IoUringPoller::queuePoll(int fd) {
+  struct io_uring_sqe *sqe = getSqe();
+  if (sqe == nullptr) {
+    LOG(ERROR) << "io_uring submission ring is full, fd " << fd << " is lost";
+    return;
+  }
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = POLLIN | POLLERR;
+  sqe->user_data = (uint64_t)fd;
+}
+
+/**
+ * @brief The timeout completes after |wait| or as soon as another
+ * completion is posted, whichever comes first. Hence it never outlives the
+ * iteration that queued it.
+ */
+void IoUringPoller::queueTimeout(TimeBase::Delta wait) {
+  struct io_uring_sqe *sqe = getSqe();
+  if (sqe == nullptr) {
+    return;
+  }
+  int64_t us = wait.toMicroseconds();
+  timeout_.tv_sec = us / 1000000;
+  timeout_.tv_nsec = us % 1000000 * 1000;
+  sqe->opcode = IORING_OP_TIMEOUT;
+  sqe->fd = -1;
+  sqe->addr = (uint64_t)&timeout_;
+  sqe->len = 1;
+  sqe->off = 1;
+  sqe->user_data = kTimeoutData;
+}
+
+int IoUringPoller::enter(unsigned int min_complete) {
+  __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+  unsigned int flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+  int rv = ioUringEnter(ring_fd_, to_submit_, min_complete, flags);
+  if (rv < 0) {
+    if (errno == EINTR) {
+      return 0;
+    }
+    LOG(ERROR) << "io_uring_enter: " << strerror(errno);
+    return -1;
+  }
+  to_submit_ -= std::min<unsigned int>(to_submit_, rv);
+  return rv;
+}
+
+bool IoUringPoller::hasCompletion() const {
+  return *cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+}
+
+bool IoUringPoller::add(int fd) {
+  queuePoll(fd);
+  return true;
+}
+
+int IoUringPoller::wait(TimeBase /* now */, TimeBase::Delta wait, int *fds,
+                        int max) {
+  unsigned int min_complete = 0;
+  if (wait > TimeBase::Delta::zero() && !hasCompletion()) {
+    min_complete = 1;
+    if (!wait.isInfinite()) {
+      queueTimeout(wait);
+    }
+  }
+
+  if ((to_submit_ > 0 || min_complete > 0) && enter(min_complete) < 0) {
+    return -1;
+  }
+
+  int count = 0;
+  unsigned int head = *cq_head_;
+  unsigned int tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  while (head != tail && count < max) {
+    struct io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+    head++;
+    if (cqe->user_data == kTimeoutData) {
+      continue;
+    }
+
+    int fd = (int)cqe->user_data;
+    if (cqe->res == -EBADF) {
+      LOG(ERROR) << "poll fd " << fd << ": " << strerror(-cqe->res);
+      continue;
+    }
+    // like EPOLLERR, a failed poll is reported so the callback sees the
+    // error, and the fd stays armed
+    if (cqe->res < 0 || (cqe->res & POLLERR)) {
+      DLOG(INFO) << "fd: " << fd << " error";
+    }
+    fds[count++] = fd;
+    // re-armed by the next io_uring_enter, after the callback drains the fd
+    queuePoll(fd);
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  return count;
+}
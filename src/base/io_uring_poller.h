@@ -0,0 +1,71 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_IO_URING_POLLER_H
+#define SRC_BASE_IO_URING_POLLER_H
+
+#include "poller.h"
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <vector>
+
+/**
+ * @brief Poller built on io_uring.
+ * Readiness polls (IORING_OP_POLL_ADD) and the loop timeout
+ * (IORING_OP_TIMEOUT) are queued in the submission ring and submitted
+ * together with one io_uring_enter per loop iteration, which also reaps the
+ * completions. The timeout has microsecond resolution, so no timerfd is
+ * needed.
+ *
+ * Polls are one-shot and re-armed after the fd is reported, which gives the
+ * same level-triggered behavior as EpollPoller.
+ */
+class IoUringPoller : public Poller {
+public:
+  IoUringPoller();
+  ~IoUringPoller() override;
+
+  inline bool isValid() const { return ring_fd_ >= 0; }
+
+  bool add(int fd) override;
+  int wait(TimeBase now, TimeBase::Delta wait, int *fds, int max) override;
+
+private:
+  struct io_uring_sqe *getSqe();
+  void queuePoll(int fd);
+  void queueTimeout(TimeBase::Delta wait);
+  int enter(unsigned int min_complete);
+  bool hasCompletion() const;
+
+  static const unsigned int kEntries = 256;
+  // user_data of the loop timeout, fds are non-negative
+  static const uint64_t kTimeoutData = ~0ull;
+
+  int ring_fd_;
+
+  // submission ring
+  void *sq_ring_;
+  size_t sq_ring_size_;
+  unsigned int *sq_head_;
+  unsigned int *sq_tail_;
+  unsigned int *sq_mask_;
+  unsigned int *sq_array_;
+  struct io_uring_sqe *sqes_;
+  size_t sqes_size_;
+  unsigned int sq_local_tail_;
+  unsigned int to_submit_;
+
+  // completion ring
+  void *cq_ring_;
+  size_t cq_ring_size_;
+  unsigned int *cq_head_;
+  unsigned int *cq_tail_;
+  unsigned int *cq_mask_;
+  struct io_uring_cqe *cqes_;
+
+  // read by the kernel when the timeout is submitted
+  struct __kernel_timespec timeout_;
+};
+
+#endif // SRC_BASE_IO_URING_POLLER_H
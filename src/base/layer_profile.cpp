@@ -0,0 +1,59 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "layer_profile.h"
+#include <algorithm>
+#include <ctime>
+
+namespace {
+
+const char *const kLayerNames[] = {"link", "network", "transport"};
+
+} // namespace
+
+thread_local LayerProfile *LayerProfile::active_ = nullptr;
+
+LayerProfile::LayerProfile()
+    : tsc_(TscClock::isSupported() ? std::make_unique<TscClock>() : nullptr),
+      nanoseconds_per_tick_(tsc_ != nullptr ? tsc_->nanosecondsPerCycle() : 1),
+      packets_(), ticks_() {}
+
+uint64_t LayerProfile::monotonicNanoseconds() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void LayerProfile::record(Layer layer, uint64_t ticks) {
+  packets_[layer]++;
+  ticks_[layer] += ticks;
+}
+
+void LayerProfile::reset() {
+  for (int i = 0; i < kLayers; i++) {
+    packets_[i] = 0;
+    ticks_[i] = 0;
+  }
+}
+
+/**
+ * @brief The self time of a layer is its time minus the time of the layer
+ * above it. The packets per second are what the layer and the layers above
+ * it could take if they had a core of their own.
+ */
+void LayerProfile::dump(std::ostream &os) const {
+  for (int i = 0; i < kLayers; i++) {
+    const double total = nanoseconds(static_cast<Layer>(i));
+    double self = total;
+    if (i + 1 < kLayers) {
+      self -= std::min(self, nanoseconds(static_cast<Layer>(i + 1)));
+    }
+    double per_packet = packets_[i] == 0 ? 0 : total / packets_[i];
+    double self_per_packet = packets_[i] == 0 ? 0 : self / packets_[i];
+    double pps = total == 0 ? 0 : packets_[i] * 1e9 / total;
+    os << kLayerNames[i] << ": packets=" << packets_[i]
+       << " ns/packet=" << per_packet << " self ns/packet=" << self_per_packet
+       << " pps=" << pps << "\n";
+  }
+}
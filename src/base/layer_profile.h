@@ -0,0 +1,86 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_LAYER_PROFILE_H
+#define SRC_BASE_LAYER_PROFILE_H
+
+#include "clock.h"
+#include "util.h"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+/**
+ * @brief Packets and time per layer of the receive path.
+ * Each layer marks its work on a packet with a |Scope|. A scope only reads
+ * a thread-local pointer, through __tls_get_addr in the shared library,
+ * unless a profile is active on the thread, which is the case while a
+ * ReplayDevice injects frames. An active profile reads the raw TSC twice
+ * per scope, the cycles are converted to nanoseconds only by |dump|.
+ *
+ * The layers nest, so the time of a layer includes the layers above it,
+ * |dump| prints both the inclusive and the self time per packet.
+ */
+class LayerProfile {
+public:
+  enum Layer {
+    LINK,
+    NETWORK,
+    TRANSPORT,
+    kLayers,
+  };
+
+  class Scope {
+  public:
+    DISALLOW_COPY_AND_ASSIGN(Scope)
+
+    explicit Scope(Layer layer)
+        : profile_(active_), layer_(layer),
+          start_(profile_ == nullptr ? 0 : profile_->ticks()) {}
+
+    ~Scope() {
+      if (profile_ != nullptr) {
+        profile_->record(layer_, profile_->ticks() - start_);
+      }
+    }
+
+  private:
+    LayerProfile *profile_;
+    Layer layer_;
+    uint64_t start_;
+  };
+
+  LayerProfile();
+
+  // Profile the scopes of this thread until |deactivate|.
+  inline void activate() { active_ = this; }
+  inline void deactivate() { active_ = nullptr; }
+
+  void record(Layer layer, uint64_t ticks);
+  void reset();
+
+  inline uint64_t packets(Layer layer) const { return packets_[layer]; }
+  inline double nanoseconds(Layer layer) const {
+    return ticks_[layer] * nanoseconds_per_tick_;
+  }
+
+  // Print packets, ns per packet and packets per second of every layer.
+  void dump(std::ostream &os) const;
+
+private:
+  // TSC cycles, or CLOCK_MONOTONIC nanoseconds without an invariant TSC
+  inline uint64_t ticks() const {
+    return tsc_ != nullptr ? TscClock::readCycles() : monotonicNanoseconds();
+  }
+  static uint64_t monotonicNanoseconds();
+
+  static thread_local LayerProfile *active_;
+
+  std::unique_ptr<TscClock> tsc_;
+  double nanoseconds_per_tick_;
+  uint64_t packets_[kLayers];
+  uint64_t ticks_[kLayers];
+};
+
+#endif // SRC_BASE_LAYER_PROFILE_H
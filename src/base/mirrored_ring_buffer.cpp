@@ -0,0 +1,96 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "mirrored_ring_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../posix/wrap_function.h"
+
+MirroredRingBuffer::MirroredRingBuffer(size_t size)
+    : size_(0), buffer_(nullptr), begin_(0), end_(0) {
+  const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_ = std::max<size_t>((size + page - 1) / page * page, page);
+
+  if (size_ > 1024 * 1024 * 16 /* 16 MB */) {
+    LOG(ERROR) << "Ringbuffer is too large";
+  }
+
+  int fd = memfd_create("ring_buffer", MFD_CLOEXEC);
+  if (fd < 0) {
+    LOG(FATAL) << "memfd_create: " << strerror(errno);
+    return;
+  }
+  if (ftruncate(fd, size_) < 0) {
+    LOG(FATAL) << "ftruncate: " << strerror(errno);
+    return;
+  }
+
+  // reserve the address range, then map the pages to both halves
+  void *base = mmap(nullptr, size_ * 2, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    LOG(FATAL) << "mmap: " << strerror(errno);
+    return;
+  }
+  buffer_ = static_cast<char *>(base);
+  for (char *view : {buffer_, buffer_ + size_}) {
+    if (mmap(view, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+             0) == MAP_FAILED) {
+      LOG(FATAL) << "mmap: " << strerror(errno);
+      return;
+    }
+  }
+  // the mappings keep the pages alive
+  __real_close(fd);
+}
+
+MirroredRingBuffer::~MirroredRingBuffer() {
+  if (buffer_ != nullptr) {
+    munmap(buffer_, size_ * 2);
+  }
+}
+
+size_t MirroredRingBuffer::read(char *buffer, size_t length) {
+  length = std::min(length, remaining());
+  memcpy(buffer, peek(), length);
+  return consume(length);
+}
+
+size_t MirroredRingBuffer::write(const char *buffer, size_t length) {
+  length = std::min(length, free());
+  if (buffer != prepare()) {
+    memcpy(prepare(), buffer, length);
+  }
+  return commit(length);
+}
+
+size_t MirroredRingBuffer::read_offset(size_t offset, char *buffer,
+                                       size_t length) {
+  if (offset >= remaining()) {
+    return 0;
+  }
+  length = std::min(length, remaining() - offset);
+  memcpy(buffer, peek(offset), length);
+  return length;
+}
+
+size_t MirroredRingBuffer::consume(size_t length) {
+  length = std::min(length, remaining());
+  begin_ += length;
+  if (begin_ >= size_) {
+    begin_ -= size_;
+    end_ -= size_;
+  }
+  return length;
+}
+
+size_t MirroredRingBuffer::commit(size_t length) {
+  length = std::min(length, free());
+  end_ += length;
+  return length;
+}
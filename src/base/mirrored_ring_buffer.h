@@ -0,0 +1,62 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_MIRRORED_RING_BUFFER_H
+#define SRC_BASE_MIRRORED_RING_BUFFER_H
+
+#include "util.h"
+
+/**
+ * @brief A RingBuffer whose pages are mapped twice back-to-back.
+ * The byte after the end of the buffer is the first byte of the buffer
+ * again, so any readable or writable region is contiguous in memory and is
+ * accessed without splitting at the wrap point.
+ *
+ * |peek| and |prepare| expose the regions directly: read from |peek| and
+ * |consume| the bytes, or fill |prepare| and |commit| the bytes. |write|
+ * does not copy bytes that were already placed at |prepare|.
+ *
+ * The size is rounded up to a multiple of the page size.
+ */
+class MirroredRingBuffer {
+public:
+  DISALLOW_COPY_AND_ASSIGN(MirroredRingBuffer)
+
+  explicit MirroredRingBuffer(size_t size);
+  ~MirroredRingBuffer();
+
+  inline size_t capacity() const { return size_; }
+
+  bool empty() const { return begin_ == end_; }
+  bool full() const { return begin_ + size_ == end_; }
+
+  size_t remaining() const { return end_ - begin_; }
+  size_t free() const { return size_ - remaining(); }
+
+  size_t read(char *buffer, size_t length);
+  size_t write(const char *buffer, size_t length);
+
+  // Read but do not consume the data.
+  size_t read_offset(size_t offset, char *buffer, size_t length);
+  size_t consume(size_t length);
+
+  // The readable bytes after |offset|, contiguous up to the end of the data.
+  inline char *peek(size_t offset = 0) { return buffer_ + begin_ + offset; }
+
+  // The free space, contiguous for |free()| bytes.
+  inline char *prepare() { return buffer_ + end_; }
+  // Append |length| bytes written to |prepare()|.
+  size_t commit(size_t length);
+
+private:
+  size_t size_;
+  // two views of the same pages, owned
+  char *buffer_;
+
+  // begin_ < size_ and end_ <= begin_ + size_
+  size_t begin_;
+  size_t end_;
+};
+
+#endif // SRC_BASE_MIRRORED_RING_BUFFER_H
@@ -0,0 +1,82 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "mirrored_ring_buffer.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <unistd.h>
+
+class MirroredRingBufferTest : public testing::Test {
+protected:
+  MirroredRingBufferTest() : buffer(1), kBufferSize(buffer.capacity()) {}
+
+  MirroredRingBuffer buffer;
+  const size_t kBufferSize;
+
+  void expectWrite(const std::string &s) {
+    EXPECT_EQ(buffer.write(s.c_str(), s.length()), s.length());
+  }
+
+  std::string read(size_t len) {
+    std::string s(len, '\0');
+    s.resize(buffer.read(&s[0], len));
+    return s;
+  }
+
+  // move the wrap point to |offset| bytes before the beginning of the data
+  void rotate(size_t offset) {
+    std::string fill(kBufferSize - offset, 'x');
+    expectWrite(fill);
+    EXPECT_EQ(read(fill.length()), fill);
+  }
+};
+
+TEST_F(MirroredRingBufferTest, Capacity) {
+  EXPECT_EQ(kBufferSize, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.free(), kBufferSize);
+}
+
+TEST_F(MirroredRingBufferTest, Wrap) {
+  rotate(3);
+  expectWrite("hello");
+  EXPECT_EQ(buffer.remaining(), 5);
+  // contiguous across the wrap point
+  EXPECT_EQ(std::string(buffer.peek(), 5), "hello");
+  EXPECT_EQ(std::string(buffer.peek(2), 3), "llo");
+  EXPECT_EQ(read(5), "hello");
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST_F(MirroredRingBufferTest, Full) {
+  rotate(10);
+  std::string data(kBufferSize, 'a');
+  data[0] = 'b';
+  expectWrite(data);
+  EXPECT_TRUE(buffer.full());
+  EXPECT_EQ(buffer.write("c", 1), 0);
+  EXPECT_EQ(buffer.commit(1), 0);
+  EXPECT_EQ(std::string(buffer.peek(), kBufferSize), data);
+}
+
+TEST_F(MirroredRingBufferTest, PrepareCommit) {
+  rotate(2);
+  memcpy(buffer.prepare(), "1234", 4);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.commit(4), 4);
+  EXPECT_EQ(buffer.consume(1), 1);
+  EXPECT_EQ(buffer.free(), kBufferSize - 3);
+  EXPECT_EQ(read(10), "234");
+}
+
+TEST_F(MirroredRingBufferTest, ReadOffset) {
+  rotate(1);
+  expectWrite("a1234");
+  char b[8];
+  EXPECT_EQ(buffer.read_offset(1, b, 8), 4);
+  EXPECT_EQ(std::string(b, 4), "1234");
+  EXPECT_EQ(buffer.read_offset(5, b, 8), 0);
+  EXPECT_EQ(buffer.read_offset(6, b, 8), 0);
+  EXPECT_EQ(buffer.remaining(), 5);
+}
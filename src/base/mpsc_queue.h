@@ -0,0 +1,65 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_MPSC_QUEUE_H
+#define SRC_BASE_MPSC_QUEUE_H
+
+#include "util.h"
+#include <atomic>
+
+/**
+ * @brief A lock-free multi-producer single-consumer queue.
+ * Producers link a node with one atomic exchange and never wait for each
+ * other or for the consumer. Only the consumer thread may call |pop|.
+ *
+ * A push that is halfway done hides the nodes pushed after it until it
+ * finishes, so |pop| may return false while the queue is not empty. The
+ * producer that finishes later is responsible for waking up the consumer.
+ */
+template <class T> class MpscQueue {
+public:
+  DISALLOW_COPY_AND_ASSIGN(MpscQueue)
+
+  MpscQueue() : head_(new Node()), tail_(head_.load()) {}
+
+  ~MpscQueue() {
+    T value;
+    while (pop(&value)) {
+    }
+    delete tail_;
+  }
+
+  void push(T value) {
+    Node *node = new Node(std::move(value));
+    Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  bool pop(T *value) {
+    Node *next = tail_->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    // |next| becomes the new stub node
+    *value = std::move(next->value);
+    delete tail_;
+    tail_ = next;
+    return true;
+  }
+
+private:
+  struct Node {
+    Node() : next(nullptr), value() {}
+    explicit Node(T v) : next(nullptr), value(std::move(v)) {}
+
+    std::atomic<Node *> next;
+    T value;
+  };
+
+  // producers push to |head_|, the consumer pops after |tail_|
+  std::atomic<Node *> head_;
+  Node *tail_;
+};
+
+#endif // SRC_BASE_MPSC_QUEUE_H
@@ -0,0 +1,70 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "mpsc_queue.h"
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+
+TEST(MpscQueueTest, Fifo) {
+  MpscQueue<int> queue;
+  int value;
+  EXPECT_FALSE(queue.pop(&value));
+
+  queue.push(1);
+  queue.push(2);
+  EXPECT_TRUE(queue.pop(&value));
+  EXPECT_EQ(value, 1);
+  queue.push(3);
+  EXPECT_TRUE(queue.pop(&value));
+  EXPECT_EQ(value, 2);
+  EXPECT_TRUE(queue.pop(&value));
+  EXPECT_EQ(value, 3);
+  EXPECT_FALSE(queue.pop(&value));
+}
+
+TEST(MpscQueueTest, Destruct) {
+  auto counter = std::make_shared<int>(0);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.push(counter);
+    queue.push(counter);
+    EXPECT_EQ(counter.use_count(), 3);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(MpscQueueTest, Producers) {
+  const int kProducers = 4;
+  const int kCount = 100000;
+  MpscQueue<std::pair<int, int>> queue;
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kProducers; i++) {
+    producers.emplace_back([&queue, i] {
+      for (int j = 0; j < kCount; j++) {
+        queue.push(std::make_pair(i, j));
+      }
+    });
+  }
+
+  // values of each producer keep their order
+  std::vector<int> next(kProducers, 0);
+  int popped = 0;
+  std::pair<int, int> value;
+  while (popped < kProducers * kCount) {
+    if (!queue.pop(&value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    EXPECT_EQ(value.second, next[value.first]);
+    next[value.first]++;
+    popped++;
+  }
+
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  EXPECT_FALSE(queue.pop(&value));
+}
@@ -0,0 +1,24 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "poller.h"
+#include "epoll_poller.h"
+#include "io_uring_poller.h"
+#include <glog/logging.h>
+
+std::unique_ptr<Poller> Poller::create(PollerType type) {
+  switch (type) {
+  case PollerType::EPOLL:
+    return std::make_unique<EpollPoller>();
+  case PollerType::IO_URING: {
+    auto poller = std::make_unique<IoUringPoller>();
+    if (poller->isValid()) {
+      return poller;
+    }
+    LOG(ERROR) << "io_uring is not available, fall back to epoll";
+    return std::make_unique<EpollPoller>();
+  }
+  }
+  return nullptr;
+}
@@ -0,0 +1,42 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_POLLER_H
+#define SRC_BASE_POLLER_H
+
+#include "time_base.h"
+#include "util.h"
+
+enum class PollerType {
+  EPOLL,
+  // falls back to EPOLL if the kernel does not support io_uring
+  IO_URING,
+};
+
+/**
+ * @brief Poller is the readiness backend of EpollServer.
+ * It only reports readable file descriptors. EpollServer dispatches them to
+ * the registered EpollCallbacks.
+ */
+class Poller {
+public:
+  DISALLOW_COPY_AND_ASSIGN(Poller)
+  Poller() = default;
+  virtual ~Poller() = default;
+
+  virtual bool add(int fd) = 0;
+
+  /**
+   * @brief Wait up to |wait| (measured from |now|) for readable file
+   * descriptors. A zero wait polls without blocking.
+   *
+   * @param fds stores at most |max| readable file descriptors
+   * @return the number of readable file descriptors, -1 on failure
+   */
+  virtual int wait(TimeBase now, TimeBase::Delta wait, int *fds, int max) = 0;
+
+  static std::unique_ptr<Poller> create(PollerType type);
+};
+
+#endif // SRC_BASE_POLLER_H
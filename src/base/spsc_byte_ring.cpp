@@ -0,0 +1,107 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "spsc_byte_ring.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t size) {
+  size_t rounded = SpscByteRing::kCacheLineSize;
+  while (rounded < size) {
+    rounded <<= 1u;
+  }
+  return rounded;
+}
+
+} // namespace
+
+SpscByteRing::SpscByteRing(size_t size)
+    : size_(roundUpToPowerOfTwo(size)), mask_(size_ - 1),
+      buffer_(new char[size_]), head_(0), cached_tail_(0), tail_(0),
+      cached_head_(0) {
+  if (size_ > 1024 * 1024 * 16 /* 16 MB */) {
+    LOG(ERROR) << "SpscByteRing is too large";
+  }
+}
+
+SpscByteRing::~SpscByteRing() { delete[] buffer_; }
+
+size_t SpscByteRing::free() {
+  cached_tail_ = tail_.load(std::memory_order_acquire);
+  return size_ - (head_.load(std::memory_order_relaxed) - cached_tail_);
+}
+
+/**
+ * @brief The free space seen by the producer, the index of the consumer is
+ * reloaded only if the cached one leaves less than |wanted| bytes.
+ */
+size_t SpscByteRing::freeAtLeast(size_t wanted) {
+  size_t available =
+      size_ - (head_.load(std::memory_order_relaxed) - cached_tail_);
+  return available < wanted ? free() : available;
+}
+
+size_t SpscByteRing::write(const char *buffer, size_t length) {
+  length = std::min(length, freeAtLeast(length));
+  if (length == 0) {
+    return 0;
+  }
+  const size_t head = head_.load(std::memory_order_relaxed);
+  const size_t offset = head & mask_;
+  const size_t first = std::min(length, size_ - offset);
+  memcpy(buffer_ + offset, buffer, first);
+  memcpy(buffer_, buffer + first, length - first);
+  head_.store(head + length, std::memory_order_release);
+  return length;
+}
+
+size_t SpscByteRing::prepare(char **data) {
+  const size_t offset = head_.load(std::memory_order_relaxed) & mask_;
+  *data = buffer_ + offset;
+  return std::min(freeAtLeast(size_ - offset), size_ - offset);
+}
+
+void SpscByteRing::commit(size_t length) {
+  DCHECK(length <= freeAtLeast(length));
+  head_.store(head_.load(std::memory_order_relaxed) + length,
+              std::memory_order_release);
+}
+
+size_t SpscByteRing::remaining() {
+  cached_head_ = head_.load(std::memory_order_acquire);
+  return cached_head_ - tail_.load(std::memory_order_relaxed);
+}
+
+size_t SpscByteRing::remainingAtLeast(size_t wanted) {
+  size_t available = cached_head_ - tail_.load(std::memory_order_relaxed);
+  return available < wanted ? remaining() : available;
+}
+
+size_t SpscByteRing::read(char *buffer, size_t length) {
+  length = std::min(length, remainingAtLeast(length));
+  if (length == 0) {
+    return 0;
+  }
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  const size_t offset = tail & mask_;
+  const size_t first = std::min(length, size_ - offset);
+  memcpy(buffer, buffer_ + offset, first);
+  memcpy(buffer + first, buffer_, length - first);
+  tail_.store(tail + length, std::memory_order_release);
+  return length;
+}
+
+size_t SpscByteRing::peek(char **data) {
+  const size_t offset = tail_.load(std::memory_order_relaxed) & mask_;
+  *data = buffer_ + offset;
+  return std::min(remainingAtLeast(size_ - offset), size_ - offset);
+}
+
+void SpscByteRing::consume(size_t length) {
+  DCHECK(length <= remainingAtLeast(length));
+  tail_.store(tail_.load(std::memory_order_relaxed) + length,
+              std::memory_order_release);
+}
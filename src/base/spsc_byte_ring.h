@@ -0,0 +1,73 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_SPSC_BYTE_RING_H
+#define SRC_BASE_SPSC_BYTE_RING_H
+
+#include "util.h"
+#include <atomic>
+
+/**
+ * @brief A lock-free single-producer single-consumer byte ring.
+ * The producer only advances |head_| and the consumer only advances |tail_|,
+ * both with release stores, so the two threads hand bytes over without a
+ * lock. Each side keeps a cached copy of the other index and reloads it only
+ * when the cached view has not enough bytes for the request.
+ *
+ * Producer calls: |free|, |write|, |prepare|, |commit|.
+ * Consumer calls: |empty|, |remaining|, |read|, |peek|, |consume|.
+ *
+ * The size is rounded up to a power of two.
+ */
+class SpscByteRing {
+public:
+  DISALLOW_COPY_AND_ASSIGN(SpscByteRing)
+
+  explicit SpscByteRing(size_t size);
+  ~SpscByteRing();
+
+  inline size_t capacity() const { return size_; }
+
+  size_t free();
+  size_t write(const char *buffer, size_t length);
+  // The contiguous free space at |*data|, fill it and |commit| the bytes.
+  size_t prepare(char **data);
+  void commit(size_t length);
+
+  bool empty() { return remaining() == 0; }
+  size_t remaining();
+  size_t read(char *buffer, size_t length);
+  // The contiguous readable bytes at |*data|, use them and |consume| them.
+  size_t peek(char **data);
+  void consume(size_t length);
+
+  static const size_t kCacheLineSize = 64;
+
+private:
+  size_t freeAtLeast(size_t wanted);
+  size_t remainingAtLeast(size_t wanted);
+
+  // read-only after construction
+  size_t size_;
+  size_t mask_;
+  // owned
+  char *buffer_;
+
+  /* The padding keeps the indices of the two sides on different cache lines
+   * however the ring itself is aligned.
+   */
+  char pad0_[kCacheLineSize];
+  // written by the producer
+  std::atomic<size_t> head_;
+  size_t cached_tail_;
+
+  char pad1_[kCacheLineSize];
+  // written by the consumer
+  std::atomic<size_t> tail_;
+  size_t cached_head_;
+
+  char pad2_[kCacheLineSize];
+};
+
+#endif // SRC_BASE_SPSC_BYTE_RING_H
@@ -0,0 +1,102 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "spsc_byte_ring.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <thread>
+
+TEST(SpscByteRingTest, Capacity) {
+  SpscByteRing ring(100);
+  EXPECT_EQ(ring.capacity(), 128);
+  EXPECT_TRUE(ring.empty());
+  EXPECT_EQ(ring.free(), 128);
+}
+
+TEST(SpscByteRingTest, Wrap) {
+  SpscByteRing ring(64);
+  char input[64], output[64];
+  for (int i = 0; i < 64; i++) {
+    input[i] = static_cast<char>(i);
+  }
+
+  EXPECT_EQ(ring.write(input, 40), 40);
+  EXPECT_EQ(ring.read(output, 30), 30);
+  // wraps around the end of the buffer
+  EXPECT_EQ(ring.write(input, 64), 54);
+  EXPECT_EQ(ring.free(), 0);
+  EXPECT_EQ(ring.write(input, 1), 0);
+
+  EXPECT_EQ(ring.read(output, 64), 64);
+  EXPECT_TRUE(ring.empty());
+  for (int i = 0; i < 64; i++) {
+    EXPECT_EQ(output[i], static_cast<char>(i < 10 ? i + 30 : i - 10)) << i;
+  }
+}
+
+TEST(SpscByteRingTest, PrepareAndPeek) {
+  SpscByteRing ring(64);
+  char *data;
+  EXPECT_EQ(ring.peek(&data), 0);
+
+  EXPECT_EQ(ring.prepare(&data), 64);
+  memset(data, 'a', 50);
+  ring.commit(50);
+  EXPECT_EQ(ring.peek(&data), 50);
+  ring.consume(40);
+
+  // the free space is split at the end of the buffer
+  EXPECT_EQ(ring.prepare(&data), 14);
+  memset(data, 'b', 14);
+  ring.commit(14);
+  EXPECT_EQ(ring.prepare(&data), 40);
+
+  EXPECT_EQ(ring.remaining(), 24);
+  EXPECT_EQ(ring.peek(&data), 24);
+  EXPECT_EQ(data[0], 'a');
+  EXPECT_EQ(data[23], 'b');
+}
+
+TEST(SpscByteRingTest, Threads) {
+  const size_t kBytes = 1 << 22;
+  SpscByteRing ring(4096);
+
+  std::thread producer([&ring] {
+    char buffer[1000];
+    size_t sent = 0;
+    while (sent < kBytes) {
+      size_t length = std::min(sizeof(buffer), kBytes - sent);
+      for (size_t i = 0; i < length; i++) {
+        buffer[i] = static_cast<char>((sent + i) % 251);
+      }
+      size_t written = 0;
+      while (written < length) {
+        size_t n = ring.write(buffer + written, length - written);
+        if (n == 0) {
+          std::this_thread::yield();
+        }
+        written += n;
+      }
+      sent += length;
+    }
+  });
+
+  char buffer[777];
+  size_t received = 0;
+  bool ordered = true;
+  while (received < kBytes) {
+    size_t length = ring.read(buffer, sizeof(buffer));
+    if (length == 0) {
+      std::this_thread::yield();
+    }
+    for (size_t i = 0; i < length; i++) {
+      ordered &= buffer[i] == static_cast<char>((received + i) % 251);
+    }
+    received += length;
+  }
+  producer.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,196 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "timing_wheel.h"
+#include <glog/logging.h>
+
+namespace {
+
+const uint64_t kSlotMask = TimingWheel::kSlots - 1;
+
+inline uint64_t rotateLeft(uint64_t value, unsigned int shift) {
+  shift &= 63u;
+  return shift == 0 ? value : (value << shift) | (value >> (64u - shift));
+}
+
+inline uint64_t rotateRight(uint64_t value, unsigned int shift) {
+  shift &= 63u;
+  return shift == 0 ? value : (value >> shift) | (value << (64u - shift));
+}
+
+} // namespace
+
+TimingWheel::Node::Node(Alarm *alarm)
+    : prev_(nullptr), next_(nullptr), expire_(0), alarm_(alarm), level_(-1),
+      slot_(0) {}
+
+/**
+ * @brief Insert this node before |head|, i.e. at the tail of the list.
+ */
+void TimingWheel::Node::link(Node *head) {
+  prev_ = head->prev_;
+  next_ = head;
+  head->prev_->next_ = this;
+  head->prev_ = this;
+}
+
+void TimingWheel::Node::unlink() {
+  prev_->next_ = next_;
+  next_->prev_ = prev_;
+  prev_ = nullptr;
+  next_ = nullptr;
+}
+
+TimingWheel::TimingWheel(TimeBase now)
+    : current_(toTick(now)), size_(0), bitmap_(), slots_(), expired_() {
+  for (auto &level : slots_) {
+    for (auto &head : level) {
+      head.prev_ = head.next_ = &head;
+    }
+  }
+  expired_.prev_ = expired_.next_ = &expired_;
+}
+
+uint64_t TimingWheel::toTick(TimeBase time) {
+  return static_cast<uint64_t>((time - TimeBase::zero()).toMicroseconds());
+}
+
+void TimingWheel::schedule(Node *node, TimeBase deadline) {
+  DCHECK(!node->isLinked());
+  node->expire_ = toTick(deadline);
+  size_++;
+  place(node);
+}
+
+void TimingWheel::cancel(Node *node) {
+  if (!node->isLinked()) {
+    return;
+  }
+  Node *head = node->level_ < 0 ? &expired_ : &slots_[node->level_][node->slot_];
+  node->unlink();
+  if (node->level_ >= 0 && head->next_ == head) {
+    bitmap_[node->level_] &= ~(1ull << node->slot_);
+  }
+  size_--;
+}
+
+/**
+ * @brief Put |node| in the level where its deadline first differs from the
+ * current tick. Deadlines beyond the span of the wheel are parked in the top
+ * level and cascade again when their slot is reached.
+ */
+void TimingWheel::place(Node *node) {
+  if (node->expire_ <= current_) {
+    node->level_ = -1;
+    node->link(&expired_);
+    return;
+  }
+
+  uint64_t diff = node->expire_ ^ current_;
+  int level = (63 - __builtin_clzll(diff)) / kSlotBits;
+  if (level >= kLevels) {
+    level = kLevels - 1;
+  }
+
+  const int shift = level * kSlotBits;
+  uint64_t distance = (node->expire_ >> shift) - (current_ >> shift);
+  if (distance > kSlotMask) {
+    distance = kSlotMask;
+  }
+  auto slot = static_cast<uint8_t>(((current_ >> shift) + distance) & kSlotMask);
+
+  node->level_ = static_cast<int8_t>(level);
+  node->slot_ = slot;
+  node->link(&slots_[level][slot]);
+  bitmap_[level] |= 1ull << slot;
+}
+
+void TimingWheel::advance(TimeBase now) {
+  const uint64_t target = toTick(now);
+  if (target <= current_) {
+    return;
+  }
+
+  Node pending;
+  pending.prev_ = pending.next_ = &pending;
+
+  for (int level = 0; level < kLevels; level++) {
+    const int shift = level * kSlotBits;
+    const uint64_t from = current_ >> shift;
+    const uint64_t to = target >> shift;
+    if (from == to) {
+      // higher levels cannot move either
+      break;
+    }
+
+    uint64_t mask;
+    if (to - from >= static_cast<uint64_t>(kSlots)) {
+      mask = ~0ull;
+    } else {
+      // slots in (from, to]
+      mask = rotateLeft((1ull << (to - from)) - 1, (from + 1) & kSlotMask);
+    }
+    mask &= bitmap_[level];
+
+    while (mask != 0) {
+      int slot = __builtin_ctzll(mask);
+      mask &= mask - 1;
+      Node *head = &slots_[level][slot];
+      // splice the whole slot to the pending list
+      head->next_->prev_ = pending.prev_;
+      pending.prev_->next_ = head->next_;
+      head->prev_->next_ = &pending;
+      pending.prev_ = head->prev_;
+      head->prev_ = head->next_ = head;
+      bitmap_[level] &= ~(1ull << slot);
+    }
+  }
+
+  current_ = target;
+  while (pending.next_ != &pending) {
+    Node *node = pending.next_;
+    node->unlink();
+    place(node);
+  }
+}
+
+TimingWheel::Node *TimingWheel::popExpired() {
+  if (expired_.next_ == &expired_) {
+    return nullptr;
+  }
+  Node *node = expired_.next_;
+  node->unlink();
+  size_--;
+  return node;
+}
+
+TimeBase::Delta TimingWheel::nextTimeout(TimeBase now) const {
+  if (expired_.next_ != &expired_) {
+    return TimeBase::Delta::zero();
+  }
+
+  uint64_t earliest = UINT64_MAX;
+  for (int level = 0; level < kLevels; level++) {
+    if (bitmap_[level] == 0) {
+      continue;
+    }
+    const int shift = level * kSlotBits;
+    const uint64_t position = current_ >> shift;
+    uint64_t ahead = rotateRight(bitmap_[level], (position + 1) & kSlotMask);
+    uint64_t distance = __builtin_ctzll(ahead) + 1;
+    // the slot is reached (and cascades) at the beginning of its range
+    earliest = std::min(earliest, (position + distance) << shift);
+  }
+
+  if (earliest == UINT64_MAX) {
+    return TimeBase::Delta::infinite();
+  }
+
+  const uint64_t tick = toTick(now);
+  if (earliest <= tick) {
+    return TimeBase::Delta::zero();
+  }
+  return TimeBase::Delta::fromMicroseconds(
+      static_cast<int64_t>(earliest - tick));
+}
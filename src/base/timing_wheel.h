@@ -0,0 +1,89 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_BASE_TIMING_WHEEL_H
+#define SRC_BASE_TIMING_WHEEL_H
+
+#include "alarm.h"
+#include "time_base.h"
+#include "util.h"
+
+/**
+ * @brief A hierarchical timing wheel with microsecond ticks.
+ * The wheel has |kLevels| levels of |kSlots| slots each. A node is kept in
+ * the level where its deadline first differs from the current tick, so that
+ * arming and canceling are O(1) and a node cascades at most |kLevels| times
+ * before it expires.
+ *
+ * Nodes are intrusive: the owner of an alarm embeds a Node and the wheel never
+ * allocates memory.
+ */
+class TimingWheel {
+public:
+  /**
+   * @brief The intrusive list hook embedded in an alarm.
+   *
+   */
+  class Node {
+  public:
+    DISALLOW_COPY_AND_ASSIGN(Node)
+    explicit Node(Alarm *alarm = nullptr);
+
+    inline bool isLinked() const { return next_ != nullptr; }
+    inline Alarm *alarm() const { return alarm_; }
+
+  private:
+    friend class TimingWheel;
+
+    void link(Node *head);
+    void unlink();
+
+    Node *prev_;
+    Node *next_;
+    uint64_t expire_;
+    Alarm *alarm_;
+    // -1 for the expired list
+    int8_t level_;
+    uint8_t slot_;
+  };
+
+  DISALLOW_COPY_AND_ASSIGN(TimingWheel)
+  explicit TimingWheel(TimeBase now);
+
+  void schedule(Node *node, TimeBase deadline);
+  void cancel(Node *node);
+
+  /**
+   * @brief Move the wheel forward to |now|. All nodes whose deadline is
+   * elapsed are moved to the expired list in one batch.
+   */
+  void advance(TimeBase now);
+
+  // Pop an expired node, nullptr if there is none.
+  Node *popExpired();
+
+  // A lower bound of the time until the next node expires.
+  TimeBase::Delta nextTimeout(TimeBase now) const;
+
+  inline bool empty() const { return size_ == 0; }
+  inline size_t size() const { return size_; }
+
+  static const int kSlotBits = 6;
+  static const int kSlots = 1 << kSlotBits;
+  static const int kLevels = 6;
+
+private:
+  static uint64_t toTick(TimeBase time);
+
+  void place(Node *node);
+
+  uint64_t current_;
+  size_t size_;
+  uint64_t bitmap_[kLevels];
+  // sentinels of circular lists
+  Node slots_[kLevels][kSlots];
+  Node expired_;
+};
+
+#endif // SRC_BASE_TIMING_WHEEL_H
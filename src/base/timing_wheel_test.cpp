@@ -0,0 +1,135 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "timing_wheel.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+class TimingWheelTest : public testing::Test {
+protected:
+  class WheelAlarm : public Alarm {
+  public:
+    WheelAlarm(TimingWheelTest *test, int id)
+        : Alarm(std::make_unique<Recorder>(test, id)), test_(test),
+          node_(this) {}
+    ~WheelAlarm() override { cancel(); }
+
+  private:
+    void setImpl() override { test_->wheel_.schedule(&node_, deadline()); }
+    void cancelImpl() override { test_->wheel_.cancel(&node_); }
+
+    TimingWheelTest *test_;
+    TimingWheel::Node node_;
+  };
+
+  class Recorder : public Alarm::Delegate {
+  public:
+    Recorder(TimingWheelTest *test, int id) : test_(test), id_(id) {}
+    void onAlarm() override { test_->fired_.push_back(id_); }
+
+  private:
+    TimingWheelTest *test_;
+    int id_;
+  };
+
+  const TimeBase kStart = TimeBase(1000 * 1000);
+
+  TimingWheelTest() : wheel_(kStart), now_(kStart) {}
+
+  void elapse(TimeBase::Delta delta) {
+    now_ = now_ + delta;
+    wheel_.advance(now_);
+    TimingWheel::Node *node;
+    while ((node = wheel_.popExpired()) != nullptr) {
+      node->alarm()->fire();
+    }
+  }
+
+  // Step to every wakeup suggested by the wheel, like EpollServer does.
+  void runUntil(TimeBase deadline) {
+    while (now_ < deadline) {
+      TimeBase::Delta step = std::min(wheel_.nextTimeout(now_), deadline - now_);
+      elapse(step);
+    }
+  }
+
+  TimingWheel wheel_;
+  TimeBase now_;
+  std::vector<int> fired_;
+};
+
+TEST_F(TimingWheelTest, Basic) {
+  WheelAlarm alarm(this, 1);
+  alarm.set(now_ + TimeBase::Delta::fromMicroseconds(10));
+  EXPECT_EQ(wheel_.size(), 1);
+  EXPECT_EQ(wheel_.nextTimeout(now_), TimeBase::Delta::fromMicroseconds(10));
+
+  elapse(TimeBase::Delta::fromMicroseconds(9));
+  EXPECT_TRUE(fired_.empty());
+  elapse(TimeBase::Delta::fromMicroseconds(1));
+  EXPECT_EQ(fired_, std::vector<int>({1}));
+  EXPECT_TRUE(wheel_.empty());
+  EXPECT_FALSE(alarm.isSet());
+}
+
+TEST_F(TimingWheelTest, Cancel) {
+  WheelAlarm a1(this, 1);
+  WheelAlarm a2(this, 2);
+  a1.set(now_ + TimeBase::Delta::fromMilliseconds(5));
+  a2.set(now_ + TimeBase::Delta::fromMilliseconds(5));
+  a1.cancel();
+  EXPECT_EQ(wheel_.size(), 1);
+
+  elapse(TimeBase::Delta::fromMilliseconds(5));
+  EXPECT_EQ(fired_, std::vector<int>({2}));
+}
+
+TEST_F(TimingWheelTest, Cascade) {
+  WheelAlarm a1(this, 1);
+  WheelAlarm a2(this, 2);
+  WheelAlarm a3(this, 3);
+  a1.set(now_ + TimeBase::Delta::fromSeconds(10));
+  a2.set(now_ + TimeBase::Delta::fromMilliseconds(300));
+  a3.set(now_ + TimeBase::Delta::fromMicroseconds(4097));
+
+  runUntil(now_ + TimeBase::Delta::fromMicroseconds(4096));
+  EXPECT_TRUE(fired_.empty());
+  runUntil(now_ + TimeBase::Delta::fromMicroseconds(1));
+  EXPECT_EQ(fired_, std::vector<int>({3}));
+
+  // never wake up later than the deadline
+  runUntil(kStart + TimeBase::Delta::fromMilliseconds(300));
+  EXPECT_EQ(fired_, std::vector<int>({3, 2}));
+  runUntil(kStart + TimeBase::Delta::fromSeconds(10) -
+           TimeBase::Delta::fromMicroseconds(1));
+  EXPECT_EQ(fired_.size(), 2);
+  runUntil(kStart + TimeBase::Delta::fromSeconds(10));
+  EXPECT_EQ(fired_, std::vector<int>({3, 2, 1}));
+}
+
+TEST_F(TimingWheelTest, LongJump) {
+  WheelAlarm a1(this, 1);
+  WheelAlarm a2(this, 2);
+  a1.set(now_ + TimeBase::Delta::fromSeconds(100000));
+  a2.set(now_ + TimeBase::Delta::fromSeconds(1));
+
+  elapse(TimeBase::Delta::fromSeconds(2));
+  EXPECT_EQ(fired_, std::vector<int>({2}));
+  elapse(TimeBase::Delta::fromSeconds(99997));
+  EXPECT_EQ(fired_.size(), 1);
+  elapse(TimeBase::Delta::fromSeconds(1));
+  EXPECT_EQ(fired_, std::vector<int>({2, 1}));
+}
+
+TEST_F(TimingWheelTest, Update) {
+  WheelAlarm alarm(this, 1);
+  alarm.set(now_ + TimeBase::Delta::fromSeconds(1));
+  alarm.update(now_ + TimeBase::Delta::fromMilliseconds(2));
+  EXPECT_EQ(wheel_.size(), 1);
+
+  elapse(TimeBase::Delta::fromMilliseconds(2));
+  EXPECT_EQ(fired_, std::vector<int>({1}));
+  elapse(TimeBase::Delta::fromSeconds(1));
+  EXPECT_EQ(fired_.size(), 1);
+}
@@ -0,0 +1,36 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_ETHER_ARP_HEADER_H
+#define SRC_ETHER_ARP_HEADER_H
+
+#include "../base/header_layout.h"
+#include "./type.h"
+#include <netinet/ether.h>
+#include <netinet/in.h>
+
+/**
+ * @brief Field layout of an ARP packet for IPv4 over Ethernet, RFC 826.
+ */
+struct ArpHeader {
+  static constexpr size_t kLength = 28;
+
+  static constexpr uint16_t kHardwareEthernet = 1;
+  static constexpr uint16_t kOperationRequest = 1;
+  static constexpr uint16_t kOperationReply = 2;
+
+  typedef HeaderField<uint16_t, 0> HardwareType;
+  typedef HeaderField<uint16_t, 2> ProtocolType;
+  typedef HeaderField<uint8_t, 4> HardwareLength;
+  typedef HeaderField<uint8_t, 5> ProtocolLength;
+  typedef HeaderField<uint16_t, 6> Operation;
+  typedef RawHeaderField<ether_addr, 8> SenderMac;
+  typedef RawHeaderField<in_addr, 14> SenderIp;
+  typedef RawHeaderField<ether_addr, 18> TargetMac;
+  typedef RawHeaderField<in_addr, 24> TargetIp;
+
+  static_assert(TargetIp::kEnd == kLength, "ARP header layout");
+};
+
+#endif // SRC_ETHER_ARP_HEADER_H
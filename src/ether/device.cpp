@@ -5,20 +5,86 @@
 #include "device.h"
 #include "../base/data_reader.h"
 #include "../base/data_writer.h"
+#include "../base/layer_profile.h"
+#include "./arp_header.h"
+#include "./ethernet_header.h"
+#include "./packet_ring_device.h"
+#include "./replay_device.h"
+#include "./tap_device.h"
 #include "./type.h"
+#include "./wire_device.h"
+#include "./xdp_device.h"
+#include <cstring>
 #include <glog/logging.h>
 
-Device::Device(pcap_t *pcap, const char *device_name)
-    : pcap_(pcap), device_name_(device_name), cb_(nullptr),
-      buffer_(new char[kEtherFrameLengthMax]),
-      mac_address_(MacAddress::fromDeviceName(device_name)),
-      ip_address_(IPAddress::fromDeviceName(device_name)) {
+Device::Device(pcap_t *pcap, const char *device_name) : Device(device_name) {
+  pcap_ = pcap;
+}
+
+Device::Device(const char *device_name)
+    : Device(device_name, MacAddress::fromDeviceName(device_name),
+             IPAddress::fromDeviceName(device_name)) {}
+
+Device::Device(const char *device_name, MacAddress mac_address,
+               IPAddress ip_address)
+    : pcap_(nullptr), device_name_(device_name), cb_(nullptr),
+      buffer_(new char[kEtherFrameLengthMax]), mac_address_(mac_address),
+      ip_address_(ip_address), neighbors_(mac_address), server_(nullptr),
+      home_(nullptr), inbox_pending_(false) {
   LOG(INFO) << device_name << " " << ip_address_.toString() << " "
             << mac_address_.toString();
 }
 
+std::unique_ptr<Device> Device::create(const char *device_name,
+                                       const DeviceConfig &config) {
+  switch (config.type) {
+  case DeviceType::PCAP:
+    return nullptr;
+  case DeviceType::PACKET_RING:
+    return PacketRingDevice::create(device_name, config);
+  case DeviceType::XDP:
+    return XdpDevice::create(device_name, config);
+  case DeviceType::TAP:
+    return TapDevice::create(device_name, config);
+  case DeviceType::WIRE:
+    return WireDevice::create(device_name, config);
+  case DeviceType::REPLAY:
+    return ReplayDevice::create(device_name, config);
+  }
+  return nullptr;
+}
+
+int Device::getFd() { return pcap_get_selectable_fd(pcap_); }
+
+bool Device::registerTo(EpollServer *server) {
+  setEpollServer(server);
+  return server->registerRead(getFd(), this);
+}
+
+bool Device::registerToGroup(EpollServerGroup *readers, EpollServer *home) {
+  setEpollServer(home);
+  home_ = home;
+  return registerQueues(readers);
+}
+
+bool Device::registerQueues(EpollServerGroup * /*readers*/) {
+  return registerTo(home_);
+}
+
 void Device::setCallback(IDeviceCallback *cb) { cb_ = cb; }
 
+void Device::setEpollServer(EpollServer *server) {
+  if (server_ == server) {
+    return;
+  }
+  server_ = server;
+  neighbor_alarm_.reset();
+  alarm_factory_ = std::make_unique<EpollAlarmFactory>(server);
+  neighbor_alarm_ =
+      std::make_unique<MemberAlarm<Device, &Device::expireNeighbors>>(
+          alarm_factory_.get(), this);
+}
+
 /**
  * @brief Encapsulate and send an Ethernet II frame to dst.
  * @param buf
@@ -51,11 +117,16 @@ void Device::decodeFrame(char *data, size_t length) {
   if (cb_ == nullptr) {
     return;
   }
+  LayerProfile::Scope scope(LayerProfile::LINK);
 
   DataReader reader(data, length);
+  const char *header = reader.readHeader<EthernetHeader>();
+  if (header == nullptr) {
+    return;
+  }
 
-  MacAddress destination(&reader);
-  MacAddress source(&reader);
+  MacAddress destination(EthernetHeader::Destination::load(header));
+  MacAddress source(EthernetHeader::Source::load(header));
 
   //  LOG(DEBUG, << source.toString() << " send to "
   //    << destination.toString());
@@ -64,21 +135,23 @@ void Device::decodeFrame(char *data, size_t length) {
     return;
   }
 
+  if (home_ != nullptr && !home_->isInLoopThread()) {
+    handOver(data, length);
+    return;
+  }
+
   if (!peer_address_.isSpecified() && !source.isBroadcast()) {
     peer_address_ = source;
     LOG(INFO) << device_name_ << " find peer: " << peer_address_.toString();
   }
 
-  uint16_t type;
-  if (!reader.readUInt16(&type)) {
-    return;
-  }
+  uint16_t type = EthernetHeader::Type::load(header);
 
   switch (type) {
-  case 0x0806: // ARP
-    LOG(INFO) << "Receive an ARP";
+  case kEtherTypeARP:
+    receiveArp(reader.buffer(), reader.length());
     return;
-  case 0x0800: // Ethernet II
+  case kEtherTypeIPv4:
     break;
   default:
     LOG(ERROR) << "unknown type in frame: " << type;
@@ -88,10 +161,179 @@ void Device::decodeFrame(char *data, size_t length) {
   cb_->onReceive(this, reader.buffer(), reader.length());
 }
 
+/**
+ * @brief The reader posts one |drainInbox| per batch. The flag is cleared
+ * before the inbox is drained, so a frame pushed after the drain started
+ * posts another one, @see MpscQueue.
+ */
+void Device::handOver(const char *data, size_t length) {
+  inbox_.push(std::string(data, length));
+  if (!inbox_pending_.exchange(true, std::memory_order_acq_rel)) {
+    home_->post([this] { drainInbox(); });
+  }
+}
+
+void Device::drainInbox() {
+  inbox_pending_.exchange(false, std::memory_order_acq_rel);
+  std::string frame;
+  while (inbox_.pop(&frame)) {
+    decodeFrame(&frame[0], frame.size());
+  }
+}
+
+void Device::encodeHeader(char *header, MacAddress dst, uint16_t type) {
+  EthernetHeader::Destination::store(header, dst.address());
+  EthernetHeader::Source::store(header, mac_address_.address());
+  EthernetHeader::Type::store(header, type);
+}
+
+void Device::encodeAndSend(char *buf, size_t len, MacAddress dst) {
+  char header[kEtherHeaderLength];
+  encodeHeader(header, dst, kEtherTypeIPv4);
+  sendFrameWithHeader(header, buf, len);
+}
+
 void Device::sendFrame(char *buf, size_t len) {
   sendFrame(buf, len, peer_address_);
 }
 
+/**
+ * @brief Copy the frame into |buffer_| and inject it with pcap.
+ */
+void Device::sendFrameWithHeader(const char *header, char *buf, size_t len) {
+  if (len > kEtherDataLengthMax) {
+    LOG(ERROR) << "frame is too long: " << len;
+    return;
+  }
+
+  char *frame = buffer_.get();
+  memcpy(frame, header, kEtherHeaderLength);
+  memcpy(frame + kEtherHeaderLength, buf, len);
+  if (len < kEtherDataLengthMin) {
+    memset(frame + kEtherHeaderLength + len, 0, kEtherDataLengthMin - len);
+    len = kEtherDataLengthMin;
+  }
+  if (pcap_sendpacket(pcap_, reinterpret_cast<const u_char *>(frame),
+                      kEtherHeaderLength + len) != 0) {
+    LOG(ERROR) << pcap_geterr(pcap_);
+  }
+}
+
+bool Device::setFilter(const std::string &expression) {
+  if (pcap_ == nullptr) {
+    return true;
+  }
+
+  bpf_program program;
+  if (pcap_compile(pcap_, &program, expression.c_str(), /* optimize = */ 1,
+                   PCAP_NETMASK_UNKNOWN) != 0) {
+    LOG(ERROR) << "pcap_compile failed " << pcap_geterr(pcap_) << ": "
+               << expression;
+    return false;
+  }
+  int rv = pcap_setfilter(pcap_, &program);
+  pcap_freecode(&program);
+  if (rv != 0) {
+    LOG(ERROR) << "pcap_setfilter failed " << pcap_geterr(pcap_);
+    return false;
+  }
+  return true;
+}
+
+void Device::sendPacket(char *buf, size_t len, IPAddress next_hop) {
+  DCHECK(server_ != nullptr);
+  TimeBase now = server_->now();
+  bool confirm;
+  const char *header = neighbors_.lookup(next_hop, now, &confirm);
+  if (header != nullptr) {
+    sendFrameWithHeader(header, buf, len);
+    if (confirm) {
+      MacAddress neighbor(EthernetHeader::Destination::load(header));
+      sendArp(ArpHeader::kOperationRequest, neighbor, MacAddress(ether_addr{}),
+              next_hop);
+    }
+    return;
+  }
+
+  if (neighbors_.enqueue(next_hop, buf, len, now)) {
+    sendArp(ArpHeader::kOperationRequest, MacAddress::broadcastAddress(),
+            MacAddress(ether_addr{}), next_hop);
+  }
+  armNeighborAlarm();
+}
+
+/**
+ * @brief Handle an ARP packet as RFC 826 says: learn the sender if it is
+ * known or the packet is for us, then answer a request for our address.
+ * The packets waiting for the sender go out at once.
+ */
+void Device::receiveArp(const char *data, size_t length) {
+  if (length < ArpHeader::kLength ||
+      ArpHeader::HardwareType::load(data) != ArpHeader::kHardwareEthernet ||
+      ArpHeader::ProtocolType::load(data) != kEtherTypeIPv4 ||
+      ArpHeader::HardwareLength::load(data) != kMacAddressLength ||
+      ArpHeader::ProtocolLength::load(data) != sizeof(in_addr)) {
+    return;
+  }
+
+  uint16_t operation = ArpHeader::Operation::load(data);
+  MacAddress sender_mac(ArpHeader::SenderMac::load(data));
+  IPAddress sender_ip(ArpHeader::SenderIp::load(data));
+  IPAddress target_ip(ArpHeader::TargetIp::load(data));
+  bool for_us = target_ip == ip_address_;
+
+  // an address probe has no sender address to learn
+  if (!sender_ip.isInaddrAny()) {
+    std::vector<std::string> pending;
+    const char *header = neighbors_.update(sender_ip, sender_mac, for_us,
+                                           server_->now(), &pending);
+    for (std::string &packet : pending) {
+      sendFrameWithHeader(header, &packet[0], packet.size());
+    }
+    armNeighborAlarm();
+  }
+
+  if (for_us && operation == ArpHeader::kOperationRequest) {
+    sendArp(ArpHeader::kOperationReply, sender_mac, sender_mac, sender_ip);
+  }
+}
+
+void Device::sendArp(uint16_t operation, MacAddress destination,
+                     MacAddress target_mac, IPAddress target_ip) {
+  char packet[ArpHeader::kLength];
+  ArpHeader::HardwareType::store(packet, ArpHeader::kHardwareEthernet);
+  ArpHeader::ProtocolType::store(packet, kEtherTypeIPv4);
+  ArpHeader::HardwareLength::store(packet, kMacAddressLength);
+  ArpHeader::ProtocolLength::store(packet, sizeof(in_addr));
+  ArpHeader::Operation::store(packet, operation);
+  ArpHeader::SenderMac::store(packet, mac_address_.address());
+  ArpHeader::SenderIp::store(packet, ip_address_.toInAddr());
+  ArpHeader::TargetMac::store(packet, target_mac.address());
+  ArpHeader::TargetIp::store(packet, target_ip.toInAddr());
+
+  char header[kEtherHeaderLength];
+  encodeHeader(header, destination, kEtherTypeARP);
+  sendFrameWithHeader(header, packet, sizeof(packet));
+}
+
+void Device::expireNeighbors() {
+  std::vector<IPAddress> requests;
+  if (neighbors_.expire(server_->now(), &requests)) {
+    armNeighborAlarm();
+  }
+  for (IPAddress address : requests) {
+    sendArp(ArpHeader::kOperationRequest, MacAddress::broadcastAddress(),
+            MacAddress(ether_addr{}), address);
+  }
+}
+
+void Device::armNeighborAlarm() {
+  if (neighbor_alarm_ != nullptr && !neighbor_alarm_->isSet() &&
+      neighbors_.size() > 0) {
+    neighbor_alarm_->set(server_->now() + NeighborTable::retryInterval());
+  }
+}
+
 Device::~Device() {
   if (pcap_ != nullptr) {
     pcap_close(pcap_);
@@ -5,16 +5,111 @@
 #ifndef TCPSTACK_DEVICE_H
 #define TCPSTACK_DEVICE_H
 
+#include "../base/embedded_alarm.h"
+#include "../base/epoll_alarm_factory.h"
 #include "../base/epoll_server.h"
+#include "../base/epoll_server_group.h"
+#include "../base/mpsc_queue.h"
+#include "../base/time_base.h"
 #include "../base/util.h"
 #include "../ip/ip_address.h"
 #include "mac_address.h"
+#include "neighbor_table.h"
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <pcap/pcap.h>
 
 class Device;
 
+enum class DeviceType {
+  // libpcap, @see DeviceManager::addDevice
+  PCAP,
+  // AF_PACKET socket with a TPACKET_V3 memory-mapped receive ring
+  PACKET_RING,
+  // AF_XDP socket, only the IPv4 traffic to the device address is redirected
+  XDP,
+  // the far end of a TAP interface, created if it does not exist
+  TAP,
+  // a port of a shared-memory wire between stacks, @see WireDevice
+  WIRE,
+  // frames read from a pcap file, @see ReplayDevice
+  REPLAY,
+};
+
+// How a ReplayDevice spaces the frames of its trace.
+enum class ReplayTiming {
+  // back to back
+  FAST,
+  // with the gaps recorded in the trace
+  ORIGINAL,
+  // with the recorded gaps divided by |DeviceConfig::replay_speed|
+  SCALED,
+};
+
+// How a PACKET_RING device with several queues spreads the frames.
+enum class FanoutMode {
+  // by the flow hash, the frames of a flow stay in one queue
+  HASH,
+  // by the CPU the frame is received on, i.e. as the RSS of the NIC
+  CPU,
+  // by the receive queue of the NIC
+  QUEUE,
+};
+
+/**
+ * @brief Per-device backend selection and tuning, @see DeviceManager.
+ */
+struct DeviceConfig {
+  DeviceType type = DeviceType::PCAP;
+
+  // frames queued by |Device::sendFrame| before they are sent at once
+  size_t tx_batch = 32;
+
+  /* PACKET_RING: the kernel fills a block with frames and retires it when it
+   * is full or |block_timeout| after its first frame. Large blocks and long
+   * timeouts batch more frames per wakeup, small ones cut the latency.
+   * With more than one of |queue_count|, each queue is a socket with a ring
+   * of its own and the sockets join a fanout group spreading the frames.
+   */
+  size_t block_size = 1u << 20u;
+  size_t block_count = 16;
+  TimeBase::Delta block_timeout = TimeBase::Delta::fromMilliseconds(1);
+  FanoutMode fanout = FanoutMode::HASH;
+
+  /* XDP: the queue to bind and the frames of the UMEM, half for receiving
+   * and half for sending. The copy mode works on any driver, e.g. veth,
+   * the zero-copy mode needs driver support.
+   */
+  uint32_t queue_id = 0;
+  size_t frame_count = 4096;
+  bool zero_copy = false;
+
+  /* TAP, WIRE and REPLAY: the stack is a host behind the interface, so it
+   * has addresses of its own. The MAC address is random if unspecified,
+   * a replay takes the destination of its first unicast IPv4 frame. More
+   * than one queue opens a TAP interface with IFF_MULTI_QUEUE.
+   */
+  IPAddress ip_address;
+  MacAddress mac_address;
+  size_t queue_count = 1;
+
+  /* WIRE: the stacks attaching a device of the same name share a wire of
+   * |port_count| ports. Each port receives on a ring of |slot_count| frames
+   * per peer port.
+   */
+  size_t port_count = 2;
+  size_t slot_count = 256;
+
+  /* REPLAY: the pcap file, its timing and how often it is replayed. The
+   * device reports the throughput of every layer when it is done.
+   */
+  std::string replay_file;
+  ReplayTiming replay_timing = ReplayTiming::FAST;
+  double replay_speed = 1;
+  size_t replay_loops = 1;
+};
+
 /**
  * @brief Link layer callback for handing packets to upper layers.
  * Network layer should derive and implement this callback interface.
@@ -33,25 +128,114 @@ public:
 class Device : public EpollCallback {
 public:
   DISALLOW_COPY_AND_ASSIGN(Device)
-  ~Device();
+  virtual ~Device();
   explicit Device(pcap_t *pcap, const char *device_name);
   void sendFrame(char *buf, size_t len);
-  void sendFrame(char *buf, size_t len, MacAddress dst);
+  virtual void sendFrame(char *buf, size_t len, MacAddress dst);
+
+  /**
+   * @brief Send a frame with a whole Ethernet header built by the caller,
+   * e.g. the header of a neighbor entry. Backends copy |header| in front
+   * of |buf| as it is.
+   */
+  virtual void sendFrameWithHeader(const char *header, char *buf,
+                                   size_t len);
+
+  /**
+   * @brief Send an IPv4 packet to the neighbor |next_hop| on this link.
+   * The packet waits for an ARP reply if the neighbor is not resolved yet.
+   */
+  void sendPacket(char *buf, size_t len, IPAddress next_hop);
+
   void setCallback(IDeviceCallback *cb);
 
+  // The loop sending the frames, its cached time ages the neighbors.
+  // |registerTo| of the pcap backend sets it as well.
+  void setEpollServer(EpollServer *server);
+
   void onReadable() override;
 
+  // The file descriptor to register to EpollServer.
+  virtual int getFd();
+
+  // Register the device to |server|, a device with several queues
+  // registers all of them.
+  virtual bool registerTo(EpollServer *server);
+
+  /**
+   * @brief Read the queues of the device in the loops of |readers|, and
+   * process the frames in |home|, the loop that also sends. A reader hands
+   * the frames for us to |home| through a lock-free queue, so the layers
+   * above stay single-threaded while the queues are read in parallel.
+   */
+  bool registerToGroup(EpollServerGroup *readers, EpollServer *home);
+
+  /**
+   * @brief Send the frames queued by |sendFrame|. DeviceManager calls it at
+   * the end of every loop iteration. Backends sending each frame at once
+   * have nothing to do.
+   */
+  virtual void flush() {}
+
+  /**
+   * @brief Let only the frames matching the pcap filter |expression| reach
+   * the device, the rest is dropped in the kernel. Backends without a pcap
+   * handle see only their own traffic and accept any filter.
+   * @return false if the filter cannot be compiled or installed
+   */
+  virtual bool setFilter(const std::string &expression);
+
+  /**
+   * @brief Create a device of a backend other than pcap.
+   * @return nullptr if |config.type| is PCAP or the backend fails to open
+   */
+  static std::unique_ptr<Device> create(const char *device_name,
+                                        const DeviceConfig &config);
+
   inline IPAddress getIpAddress() { return ip_address_; }
 
+  inline MacAddress getMacAddress() { return mac_address_; }
+
   virtual const std::string &getDeviceName() const;
 
 protected:
   // Only for testing mocks
-  Device() : pcap_(nullptr) {}
+  Device()
+      : pcap_(nullptr), neighbors_(MacAddress()), server_(nullptr),
+        home_(nullptr), inbox_pending_(false) {}
 
-private:
+  // For backends without a pcap handle.
+  explicit Device(const char *device_name);
+  Device(const char *device_name, MacAddress mac_address,
+         IPAddress ip_address);
+
+  // Spread the queues over |readers|, a device with one queue is read in
+  // the home loop.
+  virtual bool registerQueues(EpollServerGroup *readers);
+
+  // Unpack a received frame and hand the payload to |cb_|.
   void decodeFrame(char *data, size_t length);
 
+  // Write the Ethernet II header of a frame from this device to |dst|.
+  void encodeHeader(char *header, MacAddress dst, uint16_t type);
+
+  // Send an IPv4 frame to |dst| through |sendFrameWithHeader|.
+  void encodeAndSend(char *buf, size_t len, MacAddress dst);
+
+private:
+  // Answer requests for our address and learn the sender.
+  void receiveArp(const char *data, size_t length);
+  void sendArp(uint16_t operation, MacAddress destination,
+               MacAddress target_mac, IPAddress target_ip);
+  // Retry the requests of |neighbors_| and evict the failed entries.
+  void expireNeighbors();
+  // Run |expireNeighbors| after |NeighborTable::retryInterval|.
+  void armNeighborAlarm();
+  // Hand a frame read by another loop to |home_|.
+  void handOver(const char *data, size_t length);
+  // Decode the frames handed over, called in |home_|.
+  void drainInbox();
+
   /**
    * In a static network typology where the binding of an IP address and a MAC
    * address is never changed, we can keep these addresses in this class.
@@ -64,6 +248,16 @@ private:
   MacAddress mac_address_;
   MacAddress peer_address_;
   IPAddress ip_address_;
+  NeighborTable neighbors_;
+  EpollServer *server_;
+  std::unique_ptr<EpollAlarmFactory> alarm_factory_;
+  std::unique_ptr<MemberAlarm<Device, &Device::expireNeighbors>>
+      neighbor_alarm_;
+  // the loop processing the frames if the queues are read by other loops
+  EpollServer *home_;
+  MpscQueue<std::string> inbox_;
+  // a |drainInbox| task is posted to |home_| and has not run yet
+  std::atomic<bool> inbox_pending_;
 };
 
 #endif // TCPSTACK_DEVICE_H
@@ -20,21 +20,56 @@ const std::vector<Device *> &DeviceManager::getAllDevices() const {
   return devices_;
 }
 
-DeviceManager::DeviceManager(EpollServer *epoll_server)
-    : epoll_server_(epoll_server), device_list_(), devices_() {
-  pcap_if_t *all_dev;
+DeviceManager::DeviceManager(EpollServer *epoll_server,
+                             const ConfigMap &configs,
+                             EpollServerGroup *readers)
+    : epoll_server_(epoll_server), readers_(readers), callback_(nullptr),
+      device_list_(), devices_() {
+  // the frames queued by an iteration go out in one batch per device
+  epoll_server_->addIterationHook([this] { flush(); });
+
+  pcap_if_t *all_dev = nullptr;
   char errbuf[PCAP_ERRBUF_SIZE];
   if (pcap_findalldevs(&all_dev, errbuf) != 0) {
     LOG(ERROR) << errbuf;
-    return;
+    all_dev = nullptr;
   }
 
+  std::unordered_set<std::string> found;
   pcap_if_t *device;
   for (device = all_dev; device != nullptr; device = device->next) {
-    addDevice(device);
+    found.insert(device->name);
+    auto iter = configs.find(device->name);
+    if (iter == configs.end() || iter->second.type == DeviceType::PCAP) {
+      addDevice(device);
+      continue;
+    }
+
+    std::unique_ptr<Device> created =
+        Device::create(device->name, iter->second);
+    if (created == nullptr) {
+      LOG(ERROR) << "fall back to pcap: " << device->name;
+      addDevice(device);
+      continue;
+    }
+    addDevice(std::move(created));
+  }
+  if (all_dev != nullptr) {
+    pcap_freealldevs(all_dev);
   }
 
-  pcap_freealldevs(all_dev);
+  // backends like TAP create their interfaces
+  for (const auto &item : configs) {
+    if (item.second.type == DeviceType::PCAP ||
+        found.find(item.first) != found.end()) {
+      continue;
+    }
+    std::unique_ptr<Device> created =
+        Device::create(item.first.c_str(), item.second);
+    if (created != nullptr) {
+      addDevice(std::move(created));
+    }
+  }
 }
 
 DeviceManager::~DeviceManager() = default;
@@ -63,7 +98,40 @@ void DeviceManager::addDevice(pcap_if_t *device) {
 
 }
 
+Device *DeviceManager::addDevice(std::unique_ptr<Device> device) {
+  Device *rv = device.get();
+  const std::string &name = rv->getDeviceName();
+  if (device_list_.find(name) != device_list_.end()) {
+    LOG(ERROR) << "duplicate device " << name;
+    return nullptr;
+  }
+
+  rv->setEpollServer(epoll_server_);
+  bool registered = readers_ != nullptr
+                        ? rv->registerToGroup(readers_, epoll_server_)
+                        : rv->registerTo(epoll_server_);
+  if (!registered) {
+    LOG(ERROR) << "cannot register device " << name;
+    return nullptr;
+  }
+  if (callback_ != nullptr) {
+    rv->setCallback(callback_);
+  }
+
+  ip_set_.insert(rv->getIpAddress());
+  devices_.push_back(rv);
+  device_list_[name] = std::move(device);
+  return rv;
+}
+
+void DeviceManager::flush() {
+  for (Device *device : devices_) {
+    device->flush();
+  }
+}
+
 void DeviceManager::setCallback(IDeviceCallback *callback) {
+  callback_ = callback;
   for (auto &item : device_list_) {
     Device *device = item.second.get();
     device->setCallback(callback);
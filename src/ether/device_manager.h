@@ -6,6 +6,7 @@
 #define TCPSTACK_DEVICE_MANAGER_H
 
 #include "../base/epoll_server.h"
+#include "../base/epoll_server_group.h"
 #include "../base/time_base.h"
 #include "../base/util.h"
 #include "device.h"
@@ -21,7 +22,18 @@
 class DeviceManager {
 public:
   DISALLOW_COPY_AND_ASSIGN(DeviceManager)
-  explicit DeviceManager(EpollServer *epoll_server);
+  typedef std::unordered_map<std::string, DeviceConfig> ConfigMap;
+
+  /**
+   * @brief Open all devices found by pcap.
+   * @param configs the backend of each device by name, pcap if absent
+   * @param readers the loops reading the queues of the devices, the frames
+   * are processed in |epoll_server| anyway. Only |epoll_server| if null.
+   * @see Device::registerToGroup
+   */
+  explicit DeviceManager(EpollServer *epoll_server,
+                         const ConfigMap &configs = ConfigMap(),
+                         EpollServerGroup *readers = nullptr);
   ~DeviceManager();
 
   typedef std::unordered_set<IPAddress, IPAddress::IpAddressHash> IpSet;
@@ -40,8 +52,16 @@ public:
 
   IpSet getAllDevicesIpAddress() { return ip_set_; }
 
+  // Take over an opened device and register it to the epoll server.
+  Device *addDevice(std::unique_ptr<Device> device);
+
+  // Send the frames queued on all devices.
+  void flush();
+
 private:
   EpollServer *epoll_server_;
+  EpollServerGroup *readers_;
+  IDeviceCallback *callback_;
   // for quickly looking up a device
   std::unordered_map<std::string, std::unique_ptr<Device>> device_list_;
 
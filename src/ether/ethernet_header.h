@@ -0,0 +1,25 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_ETHER_ETHERNET_HEADER_H
+#define SRC_ETHER_ETHERNET_HEADER_H
+
+#include "../base/header_layout.h"
+#include "./type.h"
+#include <netinet/ether.h>
+
+/**
+ * @brief Field layout of the Ethernet II header.
+ */
+struct EthernetHeader {
+  static constexpr size_t kLength = kEtherHeaderLength;
+
+  typedef RawHeaderField<ether_addr, 0> Destination;
+  typedef RawHeaderField<ether_addr, 6> Source;
+  typedef HeaderField<uint16_t, 12> Type;
+
+  static_assert(Type::kEnd == kLength, "Ethernet header layout");
+};
+
+#endif // SRC_ETHER_ETHERNET_HEADER_H
@@ -8,6 +8,7 @@
 #include <cstring>
 #include <fstream>
 #include <net/if.h>
+#include <random>
 #include <sys/ioctl.h>
 #include <zconf.h>
 
@@ -65,6 +66,16 @@ MacAddress MacAddress::fromDeviceName(const char *device_name) {
   return MacAddress(rv);
 }
 
+MacAddress MacAddress::random() {
+  std::random_device random;
+  ether_addr address{};
+  for (uint8_t &octet : address.ether_addr_octet) {
+    octet = static_cast<uint8_t>(random());
+  }
+  address.ether_addr_octet[0] = (address.ether_addr_octet[0] & 0xfeu) | 0x02u;
+  return MacAddress(address);
+}
+
 MacAddress::MacAddress(const ether_addr &addr) : is_spec_(true), address_() {
   memcpy(&address_, &addr, sizeof(ether_addr));
 }
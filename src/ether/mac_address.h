@@ -23,12 +23,15 @@ public:
   explicit MacAddress(const ether_addr &addr);
 
   static MacAddress fromDeviceName(const char *device_name);
+  // A random locally administered unicast address.
+  static MacAddress random();
   static MacAddress broadcastAddress() { return {"FF:FF:FF:FF:FF:FF"}; };
 
   void writeTo(DataWriter *writer);
   std::string toString();
 
   inline bool isSpecified() { return is_spec_; }
+  inline const ether_addr &address() const { return address_; }
   bool isBroadcast();
 
   friend bool operator==(MacAddress lhs, MacAddress rhs);
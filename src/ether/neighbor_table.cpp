@@ -0,0 +1,124 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "neighbor_table.h"
+#include "./ethernet_header.h"
+#include <iterator>
+
+NeighborTable::NeighborTable(MacAddress mac_address)
+    : mac_address_(mac_address), entries_() {}
+
+const char *NeighborTable::lookup(IPAddress address, Time now,
+                                  bool *confirm) {
+  *confirm = false;
+  auto iter = entries_.find(address);
+  if (iter == entries_.end() || !iter->second.resolved) {
+    return nullptr;
+  }
+
+  Entry &entry = iter->second;
+  entry.used = now;
+  if (now - entry.confirmed >= reachableTime()) {
+    if (failed(entry, now)) {
+      // the neighbor is gone, resolve the address from scratch
+      entry.resolved = false;
+      entry.requests = 0;
+      return nullptr;
+    }
+    *confirm = shouldRequest(&entry, now);
+  }
+  return entry.header;
+}
+
+bool NeighborTable::enqueue(IPAddress address, const char *buf, size_t len,
+                            Time now) {
+  Entry &entry = insert(address);
+  entry.used = now;
+  if (failed(entry, now)) {
+    // |expire| has not run yet, drop the packets and start over
+    entry.pending.clear();
+    entry.requests = 0;
+  }
+
+  if (entry.pending.size() == kMaxPending) {
+    entry.pending.pop_front();
+  }
+  entry.pending.emplace_back(buf, len);
+  return shouldRequest(&entry, now);
+}
+
+const char *NeighborTable::update(IPAddress address, MacAddress mac_address,
+                                  bool create, Time now,
+                                  std::vector<std::string> *pending) {
+  auto iter = entries_.find(address);
+  if (iter == entries_.end() && !create) {
+    return nullptr;
+  }
+
+  Entry &entry = iter == entries_.end() ? insert(address) : iter->second;
+  EthernetHeader::Destination::store(entry.header, mac_address.address());
+  EthernetHeader::Source::store(entry.header, mac_address_.address());
+  EthernetHeader::Type::store(entry.header, kEtherTypeIPv4);
+  if (!entry.resolved) {
+    // a new neighbor, or the waiting packets go out now
+    entry.used = now;
+  }
+  entry.resolved = true;
+  entry.confirmed = now;
+  entry.requests = 0;
+
+  pending->assign(std::make_move_iterator(entry.pending.begin()),
+                  std::make_move_iterator(entry.pending.end()));
+  entry.pending.clear();
+  return entry.header;
+}
+
+bool NeighborTable::shouldRequest(Entry *entry, Time now) {
+  if (entry->requests >= kMaxRequests ||
+      (entry->requests != 0 && now - entry->requested < retryInterval())) {
+    return false;
+  }
+  entry->requests++;
+  entry->requested = now;
+  return true;
+}
+
+bool NeighborTable::failed(const Entry &entry, Time now) {
+  return entry.requests >= kMaxRequests &&
+         now - entry.requested >= retryInterval();
+}
+
+NeighborTable::Entry &NeighborTable::insert(IPAddress address) {
+  auto iter = entries_.find(address);
+  if (iter != entries_.end()) {
+    return iter->second;
+  }
+  if (entries_.size() >= kMaxEntries) {
+    auto victim = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); it++) {
+      if (it->second.used < victim->second.used) {
+        victim = it;
+      }
+    }
+    entries_.erase(victim);
+  }
+  return entries_[address];
+}
+
+bool NeighborTable::expire(Time now, std::vector<IPAddress> *requests) {
+  for (auto iter = entries_.begin(); iter != entries_.end();) {
+    Entry &entry = iter->second;
+    if ((!entry.resolved && failed(entry, now)) ||
+        now - entry.used >= staleTime()) {
+      iter = entries_.erase(iter);
+      continue;
+    }
+    if (!entry.resolved && !entry.pending.empty() &&
+        shouldRequest(&entry, now)) {
+      requests->push_back(iter->first);
+    }
+    iter++;
+  }
+  return !entries_.empty();
+}
@@ -0,0 +1,117 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_ETHER_NEIGHBOR_TABLE_H
+#define SRC_ETHER_NEIGHBOR_TABLE_H
+
+#include "../base/time_base.h"
+#include "../base/util.h"
+#include "../ip/ip_address.h"
+#include "mac_address.h"
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The ARP cache of a device.
+ * A resolved entry keeps the whole Ethernet header of IPv4 frames to the
+ * neighbor, so a frame starts with a copy of it. Packets to an unresolved
+ * neighbor wait in the entry until the reply arrives.
+ *
+ * The table decides when to send requests but does not send them, that is
+ * up to the Device. A request goes out for the first packet and is retried
+ * per |retryInterval| by |expire|, which the Device runs on a timer. After
+ * |kMaxRequests| unanswered requests the entry is evicted with its waiting
+ * packets. An entry older than |reachableTime| is still used, but is
+ * confirmed with a unicast request to the known address. Entries unused
+ * for |staleTime| are evicted as well, and a full table evicts the least
+ * recently used entry to make room for a new one.
+ *
+ * The time is passed in by the caller, the Device uses the time its loop
+ * cached for the iteration instead of reading a clock per packet.
+ */
+class NeighborTable {
+public:
+  DISALLOW_COPY_AND_ASSIGN(NeighborTable)
+  typedef TimeBase Time;
+
+  // |mac_address| is the source of the headers.
+  explicit NeighborTable(MacAddress mac_address);
+
+  /**
+   * @brief The Ethernet header of IPv4 frames to |address|.
+   * @param confirm set if the entry should be confirmed with a request
+   * @return nullptr if |address| is not resolved
+   */
+  const char *lookup(IPAddress address, Time now, bool *confirm);
+
+  /**
+   * @brief Keep a copy of a packet to |address| until it is resolved.
+   * @return true if a request for |address| should be sent now
+   */
+  bool enqueue(IPAddress address, const char *buf, size_t len, Time now);
+
+  /**
+   * @brief Learn the MAC address of |address| from an ARP packet. As RFC
+   * 826 says, an existing entry is always updated, but a new one is only
+   * created if |create|, i.e. the packet is for us.
+   * @param pending receives the packets waiting for |address|
+   * @return the header of the entry, nullptr if there is none
+   */
+  const char *update(IPAddress address, MacAddress mac_address, bool create,
+                     Time now, std::vector<std::string> *pending);
+
+  /**
+   * @brief Retry the requests and evict the failed and idle entries, the
+   * packets waiting in them are dropped.
+   * @param requests receives the addresses to send a request for
+   * @return false if the table is empty and needs no timer
+   */
+  bool expire(Time now, std::vector<IPAddress> *requests);
+
+  inline size_t size() const { return entries_.size(); }
+
+  static constexpr size_t kMaxPending = 16;
+  static constexpr int kMaxRequests = 3;
+  static constexpr size_t kMaxEntries = 256;
+
+  static constexpr TimeBase::Delta retryInterval() {
+    return TimeBase::Delta::fromSeconds(1);
+  }
+  static constexpr TimeBase::Delta reachableTime() {
+    return TimeBase::Delta::fromSeconds(30);
+  }
+  static constexpr TimeBase::Delta staleTime() {
+    return TimeBase::Delta::fromSeconds(60);
+  }
+
+private:
+  struct Entry {
+    char header[kEtherHeaderLength];
+    bool resolved = false;
+    // when the address was learned
+    Time confirmed = TimeBase::zero();
+    // when the last request was sent
+    Time requested = TimeBase::zero();
+    // requests since the address was learned
+    int requests = 0;
+    // when a packet was last sent to the address
+    Time used = TimeBase::zero();
+    std::deque<std::string> pending;
+  };
+
+  // Count a request if the last one is |retryInterval| ago.
+  static bool shouldRequest(Entry *entry, Time now);
+  // The requests for the entry went unanswered.
+  static bool failed(const Entry &entry, Time now);
+
+  // The entry of |address|, a full table evicts the least recently used one.
+  Entry &insert(IPAddress address);
+
+  MacAddress mac_address_;
+  std::unordered_map<IPAddress, Entry, IPAddress::IpAddressHash> entries_;
+};
+
+#endif // SRC_ETHER_NEIGHBOR_TABLE_H
@@ -0,0 +1,181 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "neighbor_table.h"
+#include "ethernet_header.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const MacAddress kSelf("02:00:00:00:00:01");
+const MacAddress kNeighbor("02:00:00:00:00:02");
+const IPAddress kAddress("10.0.0.2");
+
+} // namespace
+
+TEST(NeighborTableTest, Resolve) {
+  NeighborTable table(kSelf);
+  TimeBase now(1);
+  bool confirm;
+  EXPECT_EQ(table.lookup(kAddress, now, &confirm), nullptr);
+
+  // only the first packet sends a request
+  EXPECT_TRUE(table.enqueue(kAddress, "a", 1, now));
+  EXPECT_FALSE(table.enqueue(kAddress, "b", 1, now));
+  EXPECT_EQ(table.lookup(kAddress, now, &confirm), nullptr);
+
+  std::vector<std::string> pending;
+  const char *header = table.update(kAddress, kNeighbor, false, now, &pending);
+  ASSERT_NE(header, nullptr);
+  EXPECT_EQ(pending, std::vector<std::string>({"a", "b"}));
+  EXPECT_EQ(MacAddress(EthernetHeader::Destination::load(header)), kNeighbor);
+  EXPECT_EQ(MacAddress(EthernetHeader::Source::load(header)), kSelf);
+  EXPECT_EQ(EthernetHeader::Type::load(header), kEtherTypeIPv4);
+
+  EXPECT_EQ(table.lookup(kAddress, now, &confirm), header);
+  EXPECT_FALSE(confirm);
+}
+
+TEST(NeighborTableTest, Create) {
+  NeighborTable table(kSelf);
+  TimeBase now(1);
+  std::vector<std::string> pending;
+
+  // an ARP packet not for us only updates known entries
+  EXPECT_EQ(table.update(kAddress, kNeighbor, false, now, &pending), nullptr);
+  EXPECT_EQ(table.size(), 0);
+  EXPECT_NE(table.update(kAddress, kNeighbor, true, now, &pending), nullptr);
+  EXPECT_EQ(table.size(), 1);
+  EXPECT_TRUE(pending.empty());
+}
+
+TEST(NeighborTableTest, Retry) {
+  NeighborTable table(kSelf);
+  TimeBase now(1);
+  auto retry = NeighborTable::retryInterval();
+
+  for (int i = 0; i < NeighborTable::kMaxRequests; i++) {
+    EXPECT_TRUE(table.enqueue(kAddress, "a", 1, now)) << i;
+    EXPECT_FALSE(table.enqueue(kAddress, "a", 1, now + retry * 0.5)) << i;
+    now = now + retry;
+  }
+
+  // the packets are dropped and the resolution starts over
+  EXPECT_TRUE(table.enqueue(kAddress, "b", 1, now));
+  std::vector<std::string> pending;
+  table.update(kAddress, kNeighbor, false, now, &pending);
+  EXPECT_EQ(pending, std::vector<std::string>({"b"}));
+}
+
+TEST(NeighborTableTest, PendingLimit) {
+  NeighborTable table(kSelf);
+  TimeBase now(1);
+  size_t limit = NeighborTable::kMaxPending;
+  for (size_t i = 0; i <= limit; i++) {
+    std::string packet = std::to_string(i);
+    table.enqueue(kAddress, packet.data(), packet.size(), now);
+  }
+
+  std::vector<std::string> pending;
+  table.update(kAddress, kNeighbor, false, now, &pending);
+  ASSERT_EQ(pending.size(), limit);
+  // the oldest packet is dropped
+  EXPECT_EQ(pending.front(), "1");
+}
+
+TEST(NeighborTableTest, Confirm) {
+  NeighborTable table(kSelf);
+  TimeBase now(1);
+  std::vector<std::string> pending;
+  const char *header = table.update(kAddress, kNeighbor, true, now, &pending);
+
+  // a stale entry is still used while it is confirmed
+  now = now + NeighborTable::reachableTime();
+  bool confirm;
+  for (int i = 0; i < NeighborTable::kMaxRequests; i++) {
+    EXPECT_EQ(table.lookup(kAddress, now, &confirm), header);
+    EXPECT_TRUE(confirm) << i;
+    EXPECT_EQ(table.lookup(kAddress, now, &confirm), header);
+    EXPECT_FALSE(confirm) << i;
+    now = now + NeighborTable::retryInterval();
+  }
+
+  // nobody answered
+  EXPECT_EQ(table.lookup(kAddress, now, &confirm), nullptr);
+  EXPECT_TRUE(table.enqueue(kAddress, "a", 1, now));
+
+  // an answer makes it reachable again
+  table.update(kAddress, kNeighbor, false, now, &pending);
+  EXPECT_EQ(table.lookup(kAddress, now, &confirm), header);
+  EXPECT_FALSE(confirm);
+}
+
+TEST(NeighborTableTest, ExpireRetry) {
+  NeighborTable table(kSelf);
+  TimeBase now(1);
+  auto retry = NeighborTable::retryInterval();
+  EXPECT_TRUE(table.enqueue(kAddress, "a", 1, now));
+
+  // the timer retries without any new packet
+  std::vector<IPAddress> requests;
+  EXPECT_TRUE(table.expire(now + retry * 0.5, &requests));
+  EXPECT_TRUE(requests.empty());
+  for (int i = 1; i < NeighborTable::kMaxRequests; i++) {
+    now = now + retry;
+    requests.clear();
+    EXPECT_TRUE(table.expire(now, &requests)) << i;
+    EXPECT_EQ(requests, std::vector<IPAddress>({kAddress})) << i;
+  }
+
+  // nobody answered, the entry and its packets are gone
+  now = now + retry;
+  requests.clear();
+  EXPECT_FALSE(table.expire(now, &requests));
+  EXPECT_TRUE(requests.empty());
+  EXPECT_EQ(table.size(), 0);
+}
+
+TEST(NeighborTableTest, ExpireIdle) {
+  NeighborTable table(kSelf);
+  TimeBase now(1);
+  std::vector<std::string> pending;
+  table.update(kAddress, kNeighbor, true, now, &pending);
+  bool confirm;
+
+  std::vector<IPAddress> requests;
+  now = now + NeighborTable::staleTime() * 0.5;
+  EXPECT_NE(table.lookup(kAddress, now, &confirm), nullptr);
+  now = now + NeighborTable::staleTime() * 0.5;
+  EXPECT_TRUE(table.expire(now, &requests));
+
+  now = now + NeighborTable::staleTime() * 0.5;
+  EXPECT_FALSE(table.expire(now, &requests));
+  EXPECT_EQ(table.lookup(kAddress, now, &confirm), nullptr);
+  EXPECT_TRUE(requests.empty());
+}
+
+TEST(NeighborTableTest, EntryLimit) {
+  NeighborTable table(kSelf);
+  TimeBase now(1);
+  std::vector<std::string> pending;
+  size_t limit = NeighborTable::kMaxEntries;
+  in_addr_t base = ntohl(IPAddress("10.1.0.0").toInAddr().s_addr);
+  for (size_t i = 0; i < limit; i++) {
+    in_addr address{htonl(base + i)};
+    table.update(IPAddress(address), kNeighbor, true,
+                 now + TimeBase::Delta::fromMilliseconds(i), &pending);
+  }
+  EXPECT_EQ(table.size(), limit);
+
+  // the least recently used entry makes room
+  bool confirm;
+  now = now + TimeBase::Delta::fromSeconds(1);
+  in_addr first{htonl(base)};
+  EXPECT_NE(table.lookup(IPAddress(first), now, &confirm), nullptr);
+  table.enqueue(kAddress, "a", 1, now);
+  EXPECT_EQ(table.size(), limit);
+  EXPECT_NE(table.lookup(IPAddress(first), now, &confirm), nullptr);
+  in_addr second{htonl(base + 1)};
+  EXPECT_EQ(table.lookup(IPAddress(second), now, &confirm), nullptr);
+}
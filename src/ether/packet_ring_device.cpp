@@ -0,0 +1,331 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "packet_ring_device.h"
+#include "../posix/wrap_function.h"
+#include "./type.h"
+#include <algorithm>
+#include <cstring>
+#include <glog/logging.h>
+#include <linux/filter.h>
+#include <linux/if_packet.h>
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// V3 frames have variable sizes, this only bounds the frame count
+const size_t kFrameSize = 2048;
+// a slot of the send queue
+const size_t kSlotSize = kEtherHeaderLength + kEtherDataLengthMax;
+
+} // namespace
+
+PacketRingDevice::Queue::Queue(PacketRingDevice *device, int fd)
+    : device_(device), fd_(fd), ring_(nullptr), block_size_(0),
+      block_count_(0), current_block_(0) {}
+
+PacketRingDevice::Queue::~Queue() {
+  if (ring_ != nullptr) {
+    munmap(ring_, block_size_ * block_count_);
+  }
+  __real_close(fd_);
+}
+
+PacketRingDevice::PacketRingDevice(const char *device_name, int if_index)
+    : Device(device_name), if_index_(if_index), queues_(), tx_frames_(),
+      tx_iovs_(), tx_msgs_(), tx_queued_(0) {}
+
+PacketRingDevice::~PacketRingDevice() = default;
+
+std::unique_ptr<PacketRingDevice>
+PacketRingDevice::create(const char *device_name, const DeviceConfig &config) {
+  int if_index = static_cast<int>(if_nametoindex(device_name));
+  if (if_index == 0) {
+    LOG(ERROR) << "if_nametoindex failed " << strerror(errno) << ": "
+               << device_name;
+    return nullptr;
+  }
+
+  std::unique_ptr<PacketRingDevice> device(
+      new PacketRingDevice(device_name, if_index));
+  const size_t queue_count = std::max<size_t>(config.queue_count, 1);
+  uint16_t group_id = 0;
+  for (size_t i = 0; i < queue_count; i++) {
+    int fd = openSocket(device_name);
+    if (fd < 0) {
+      return nullptr;
+    }
+    device->queues_.push_back(std::make_unique<Queue>(device.get(), fd));
+    Queue *queue = device->queues_.back().get();
+    if (!queue->setupRing(config, if_index)) {
+      return nullptr;
+    }
+    if (queue_count > 1 && !queue->joinFanout(config.fanout, &group_id)) {
+      return nullptr;
+    }
+  }
+  device->setupQueue(config);
+  return device;
+}
+
+int PacketRingDevice::openSocket(const char *device_name) {
+  int fd = __real_socket(AF_PACKET, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                         htons(ETH_P_ALL));
+  if (fd < 0) {
+    LOG(ERROR) << "socket failed " << strerror(errno) << ": " << device_name;
+  }
+  return fd;
+}
+
+/**
+ * @brief Switch the socket to TPACKET_V3, map its receive ring and bind it
+ * to the interface. The block size is rounded up to a power of two pages.
+ */
+bool PacketRingDevice::Queue::setupRing(const DeviceConfig &config,
+                                        int if_index) {
+  int version = TPACKET_V3;
+  int rv = setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version,
+                      sizeof(version));
+  if (rv < 0) {
+    LOG(ERROR) << "PACKET_VERSION failed " << strerror(errno);
+    return false;
+  }
+
+  size_t block_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  while (block_size < std::max(config.block_size, kFrameSize)) {
+    block_size <<= 1u;
+  }
+  size_t block_count = std::max<size_t>(config.block_count, 2);
+  int64_t timeout = std::max<int64_t>(config.block_timeout.toMilliseconds(), 1);
+
+  tpacket_req3 req{};
+  req.tp_block_size = block_size;
+  req.tp_block_nr = block_count;
+  req.tp_frame_size = kFrameSize;
+  req.tp_frame_nr = block_size / kFrameSize * block_count;
+  req.tp_retire_blk_tov = static_cast<unsigned>(timeout);
+  rv = setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+  if (rv < 0) {
+    LOG(ERROR) << "PACKET_RX_RING failed " << strerror(errno);
+    return false;
+  }
+
+  void *ring = mmap(nullptr, block_size * block_count, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, 0);
+  if (ring == MAP_FAILED) {
+    LOG(ERROR) << "mmap failed " << strerror(errno);
+    return false;
+  }
+  ring_ = static_cast<char *>(ring);
+  block_size_ = block_size;
+  block_count_ = block_count;
+
+  sockaddr_ll address{};
+  address.sll_family = AF_PACKET;
+  address.sll_protocol = htons(ETH_P_ALL);
+  address.sll_ifindex = if_index;
+  rv = __real_bind(fd_, reinterpret_cast<sockaddr *>(&address),
+                   sizeof(address));
+  if (rv < 0) {
+    LOG(ERROR) << "bind failed " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief The first socket lets the kernel pick an unused group id, so the
+ * groups of stacks on the same interface never merge. The other sockets
+ * join it by that id.
+ */
+bool PacketRingDevice::Queue::joinFanout(FanoutMode mode,
+                                         uint16_t *group_id) {
+  uint32_t type = PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG;
+  if (mode == FanoutMode::CPU) {
+    type = PACKET_FANOUT_CPU;
+  } else if (mode == FanoutMode::QUEUE) {
+    type = PACKET_FANOUT_QM;
+  }
+  if (*group_id == 0) {
+    type |= PACKET_FANOUT_FLAG_UNIQUEID;
+  }
+
+  uint32_t arg = *group_id | (type << 16u);
+  if (setsockopt(fd_, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)) < 0) {
+    LOG(ERROR) << "PACKET_FANOUT failed " << strerror(errno);
+    return false;
+  }
+  if (*group_id == 0) {
+    socklen_t len = sizeof(arg);
+    if (getsockopt(fd_, SOL_PACKET, PACKET_FANOUT, &arg, &len) < 0) {
+      LOG(ERROR) << "PACKET_FANOUT failed " << strerror(errno);
+      return false;
+    }
+    *group_id = static_cast<uint16_t>(arg & 0xffffu);
+  }
+  return true;
+}
+
+bool PacketRingDevice::registerTo(EpollServer *server) {
+  for (auto &queue : queues_) {
+    if (!server->registerRead(queue->fd(), queue.get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PacketRingDevice::registerQueues(EpollServerGroup *readers) {
+  size_t first = readers->nextIndex();
+  for (size_t i = 0; i < queues_.size(); i++) {
+    EpollServer *server = readers->getServer((first + i) % readers->size());
+    if (!server->registerRead(queues_[i]->fd(), queues_[i].get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PacketRingDevice::setupQueue(const DeviceConfig &config) {
+  size_t slots = std::max<size_t>(config.tx_batch, 1);
+  tx_frames_.reset(new char[slots * kSlotSize]);
+  tx_iovs_.resize(slots);
+  tx_msgs_.resize(slots);
+  for (size_t i = 0; i < slots; i++) {
+    tx_iovs_[i].iov_base = tx_frames_.get() + i * kSlotSize;
+    tx_msgs_[i] = {};
+    tx_msgs_[i].msg_hdr.msg_iov = &tx_iovs_[i];
+    tx_msgs_[i].msg_hdr.msg_iovlen = 1;
+  }
+}
+
+void PacketRingDevice::sendFrameWithHeader(const char *header, char *buf,
+                                           size_t len) {
+  if (len > kEtherDataLengthMax) {
+    LOG(ERROR) << "frame is too long: " << len;
+    return;
+  }
+
+  // |buf| is reused by the caller, so the frame is copied into the queue
+  char *frame = tx_frames_.get() + tx_queued_ * kSlotSize;
+  memcpy(frame, header, kEtherHeaderLength);
+  memcpy(frame + kEtherHeaderLength, buf, len);
+  if (len < kEtherDataLengthMin) {
+    // short frames are padded up to the minimum Ethernet payload
+    memset(frame + kEtherHeaderLength + len, 0, kEtherDataLengthMin - len);
+    len = kEtherDataLengthMin;
+  }
+  tx_iovs_[tx_queued_].iov_len = kEtherHeaderLength + len;
+
+  if (++tx_queued_ == tx_msgs_.size()) {
+    flush();
+  }
+}
+
+void PacketRingDevice::flush() {
+  size_t sent = 0;
+  while (sent < tx_queued_) {
+    int rv = sendmmsg(queues_.front()->fd(), tx_msgs_.data() + sent,
+                      tx_queued_ - sent, 0);
+    if (rv < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG(ERROR) << "sendmmsg failed " << strerror(errno) << ", drop "
+                 << tx_queued_ - sent << " frames: " << getDeviceName();
+      break;
+    }
+    sent += rv;
+  }
+  tx_queued_ = 0;
+}
+
+/**
+ * @brief libpcap compiles the filter against a dead Ethernet handle, its
+ * classic BPF program is what the kernel runs on AF_PACKET sockets, so the
+ * instructions are attached as they are.
+ */
+bool PacketRingDevice::setFilter(const std::string &expression) {
+  pcap_t *pcap = pcap_open_dead(DLT_EN10MB, kEtherFrameLengthMax);
+  if (pcap == nullptr) {
+    LOG(ERROR) << "pcap_open_dead failed";
+    return false;
+  }
+
+  bpf_program program;
+  if (pcap_compile(pcap, &program, expression.c_str(), /* optimize = */ 1,
+                   PCAP_NETMASK_UNKNOWN) != 0) {
+    LOG(ERROR) << "pcap_compile failed " << pcap_geterr(pcap) << ": "
+               << expression;
+    pcap_close(pcap);
+    return false;
+  }
+
+  static_assert(sizeof(sock_filter) == sizeof(bpf_insn), "BPF instruction");
+  sock_fprog filter{static_cast<unsigned short>(program.bf_len),
+                    reinterpret_cast<sock_filter *>(program.bf_insns)};
+  bool rv = true;
+  for (auto &queue : queues_) {
+    if (setsockopt(queue->fd(), SOL_SOCKET, SO_ATTACH_FILTER, &filter,
+                   sizeof(filter)) < 0) {
+      LOG(ERROR) << "SO_ATTACH_FILTER failed " << strerror(errno) << ": "
+                 << getDeviceName();
+      rv = false;
+      break;
+    }
+  }
+  pcap_freecode(&program);
+  pcap_close(pcap);
+  return rv;
+}
+
+void PacketRingDevice::onReadable() {
+  for (auto &queue : queues_) {
+    queue->onReadable();
+  }
+}
+
+/**
+ * @brief Hand all frames of the retired blocks to the callback.
+ * The blocks are retired in order, so stop at the first one still owned by
+ * the kernel. At most one round of the ring is walked per call, the socket
+ * stays readable if there are more.
+ */
+void PacketRingDevice::Queue::onReadable() {
+  for (size_t i = 0; i < block_count_; i++) {
+    char *block = ring_ + current_block_ * block_size_;
+    auto *desc = reinterpret_cast<tpacket_block_desc *>(block);
+    uint32_t status =
+        __atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE);
+    if ((status & TP_STATUS_USER) == 0) {
+      break;
+    }
+
+    walkBlock(block);
+
+    __atomic_store_n(&desc->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                     __ATOMIC_RELEASE);
+    current_block_ = (current_block_ + 1) % block_count_;
+  }
+}
+
+void PacketRingDevice::Queue::walkBlock(char *block) {
+  auto *desc = reinterpret_cast<tpacket_block_desc *>(block);
+  char *frame = block + desc->hdr.bh1.offset_to_first_pkt;
+
+  for (uint32_t i = 0; i < desc->hdr.bh1.num_pkts; i++) {
+    auto *header = reinterpret_cast<tpacket3_hdr *>(frame);
+    auto *link = reinterpret_cast<sockaddr_ll *>(
+        frame + TPACKET_ALIGN(sizeof(tpacket3_hdr)));
+    // the socket also sees the frames we send
+    if (link->sll_pkttype != PACKET_OUTGOING) {
+      device_->decodeFrame(frame + header->tp_mac, header->tp_snaplen);
+    }
+    frame += header->tp_next_offset;
+  }
+}
@@ -0,0 +1,104 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_ETHER_PACKET_RING_DEVICE_H
+#define SRC_ETHER_PACKET_RING_DEVICE_H
+
+#include "device.h"
+#include <sys/socket.h>
+#include <vector>
+
+/**
+ * @brief A device on an AF_PACKET socket with a TPACKET_V3 receive ring.
+ * The kernel writes frames into blocks of a ring mapped into our address
+ * space. |onReadable| walks every retired block, hands the frames to the
+ * callback in place and returns the block to the kernel, so there is no
+ * copy and no syscall per frame.
+ * Frames to send are copied into a queue of |DeviceConfig::tx_batch| slots,
+ * which is sent with one sendmmsg when it is full or flushed.
+ *
+ * With several queues every queue is a socket with its own ring, and the
+ * sockets join a PACKET_FANOUT group, so the kernel spreads the frames as
+ * |DeviceConfig::fanout| says, e.g. the frames of a flow stay in one
+ * queue. The queues are registered as EpollCallbacks of their own, and are
+ * read in parallel if the device is registered to an EpollServerGroup.
+ */
+class PacketRingDevice : public Device {
+public:
+  DISALLOW_COPY_AND_ASSIGN(PacketRingDevice)
+  ~PacketRingDevice() override;
+
+  /**
+   * @brief Open the sockets, set up and map the rings of |config|.
+   * @return nullptr on failure, e.g. without CAP_NET_RAW
+   */
+  static std::unique_ptr<PacketRingDevice> create(const char *device_name,
+                                                  const DeviceConfig &config);
+
+  using Device::sendFrame;
+  void sendFrame(char *buf, size_t len, MacAddress dst) override {
+    encodeAndSend(buf, len, dst);
+  }
+  void sendFrameWithHeader(const char *header, char *buf,
+                           size_t len) override;
+
+  // Walk the rings of all queues.
+  void onReadable() override;
+
+  int getFd() override { return queues_.front()->fd(); }
+
+  bool registerTo(EpollServer *server) override;
+
+  void flush() override;
+
+  // Compile |expression| with libpcap and attach it to every socket.
+  bool setFilter(const std::string &expression) override;
+
+protected:
+  // Register the queues to consecutive loops of |readers|.
+  bool registerQueues(EpollServerGroup *readers) override;
+
+private:
+  class Queue : public EpollCallback {
+  public:
+    Queue(PacketRingDevice *device, int fd);
+    ~Queue();
+
+    bool setupRing(const DeviceConfig &config, int if_index);
+    // Join the fanout group |group_id|, or create one if it is 0.
+    bool joinFanout(FanoutMode mode, uint16_t *group_id);
+
+    void onReadable() override;
+
+    inline int fd() const { return fd_; }
+
+  private:
+    void walkBlock(char *block);
+
+    PacketRingDevice *device_;
+    int fd_;
+    // the mapped ring of |block_count_| blocks
+    char *ring_;
+    size_t block_size_;
+    size_t block_count_;
+    // the next block to be retired by the kernel
+    size_t current_block_;
+  };
+
+  PacketRingDevice(const char *device_name, int if_index);
+
+  static int openSocket(const char *device_name);
+  void setupQueue(const DeviceConfig &config);
+
+  int if_index_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  // |tx_msgs_[i]| sends the frame in slot i of |tx_frames_|
+  std::unique_ptr<char[]> tx_frames_;
+  std::vector<iovec> tx_iovs_;
+  std::vector<mmsghdr> tx_msgs_;
+  size_t tx_queued_;
+};
+
+#endif // SRC_ETHER_PACKET_RING_DEVICE_H
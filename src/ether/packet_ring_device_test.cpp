@@ -0,0 +1,118 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "packet_ring_device.h"
+#include "../ip/ipv4_header.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <thread>
+
+namespace {
+
+const IPAddress kDestination("127.0.0.254");
+
+// Count the packets to |kDestination| per source address.
+class FlowCounter : public IDeviceCallback {
+public:
+  void onReceive(Device * /*device*/, char *buf, size_t len) override {
+    if (len < IPv4Header::kLength ||
+        IPAddress(IPv4Header::Destination::load(buf)) != kDestination) {
+      return;
+    }
+    packets[IPv4Header::Source::load(buf).s_addr]++;
+    one_thread = one_thread && std::this_thread::get_id() == thread;
+  }
+
+  std::map<uint32_t, int> packets;
+  std::thread::id thread;
+  bool one_thread = true;
+};
+
+std::unique_ptr<PacketRingDevice> createDevice() {
+  DeviceConfig config;
+  config.type = DeviceType::PACKET_RING;
+  config.queue_count = 4;
+  config.block_size = 4096;
+  config.block_count = 4;
+  return PacketRingDevice::create("lo", config);
+}
+
+// Send one packet from each of |flows| sources to |kDestination|.
+void sendFlows(Device *device, int flows) {
+  for (int i = 0; i < flows; i++) {
+    char packet[IPv4Header::kLength] = {};
+    IPv4Header::VersionAndLength::store(packet, 0x45);
+    IPv4Header::TotalLength::store(packet, IPv4Header::kLength);
+    IPv4Header::TimeToLive::store(packet, 64);
+    in_addr source{htonl(0x7f000100u + i)};
+    IPv4Header::Source::store(packet, source);
+    IPv4Header::Destination::store(packet, kDestination.toInAddr());
+    device->sendFrame(packet, sizeof(packet), device->getMacAddress());
+  }
+  device->flush();
+}
+
+} // namespace
+
+/**
+ * The queues of a device form one fanout group, so every frame is read
+ * once by one of them and not once per socket.
+ */
+TEST(PacketRingDeviceTest, Fanout) {
+  auto device = createDevice();
+  if (device == nullptr) {
+    GTEST_SKIP() << "AF_PACKET needs CAP_NET_RAW";
+  }
+
+  FlowCounter counter;
+  counter.thread = std::this_thread::get_id();
+  device->setCallback(&counter);
+  EpollServer server;
+  device->setEpollServer(&server);
+  ASSERT_TRUE(device->registerTo(&server));
+
+  const int kFlows = 64;
+  sendFlows(device.get(), kFlows);
+
+  // the blocks are retired by their timeout
+  for (int i = 0; i < 100 && counter.packets.size() < kFlows; i++) {
+    server.runEventLoop(TimeBase::Delta::fromMilliseconds(10));
+  }
+  ASSERT_EQ(counter.packets.size(), kFlows);
+  for (const auto &item : counter.packets) {
+    EXPECT_EQ(item.second, 1);
+  }
+}
+
+/**
+ * The queues are read by the loops of a group, and the frames reach the
+ * callback in the home loop only.
+ */
+TEST(PacketRingDeviceTest, Readers) {
+  auto device = createDevice();
+  if (device == nullptr) {
+    GTEST_SKIP() << "AF_PACKET needs CAP_NET_RAW";
+  }
+
+  FlowCounter counter;
+  counter.thread = std::this_thread::get_id();
+  device->setCallback(&counter);
+  EpollServer home;
+  EpollServerGroup readers(4);
+  ASSERT_TRUE(device->registerToGroup(&readers, &home));
+  readers.start();
+
+  const int kFlows = 64;
+  sendFlows(device.get(), kFlows);
+
+  for (int i = 0; i < 100 && counter.packets.size() < kFlows; i++) {
+    home.runEventLoop(TimeBase::Delta::fromMilliseconds(10));
+  }
+  readers.stop();
+  ASSERT_EQ(counter.packets.size(), kFlows);
+  for (const auto &item : counter.packets) {
+    EXPECT_EQ(item.second, 1);
+  }
+  EXPECT_TRUE(counter.one_thread);
+}
@@ -0,0 +1,245 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "replay_device.h"
+#include "../ip/ipv4_header.h"
+#include "../posix/wrap_function.h"
+#include "./ethernet_header.h"
+#include "./type.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <glog/logging.h>
+#include <sstream>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+// frames injected per wakeup, so the loop gets to its other events
+const int kReplayBudget = 64;
+const uint64_t kNanosecondsPerSecond = 1000000000;
+
+// CLOCK_MONOTONIC in nanoseconds, the clock of the timerfd pacing frames.
+uint64_t monotonicNow() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * kNanosecondsPerSecond + ts.tv_nsec;
+}
+
+/**
+ * @brief The destination addresses of the first unicast IPv4 frame, a
+ * trace is replayed to the host it was captured on.
+ */
+bool findDestination(const char *data, size_t length,
+                     ether_addr *mac_address, in_addr *ip_address) {
+  if (length < EthernetHeader::kLength + IPv4Header::kLength ||
+      EthernetHeader::Type::load(data) != kEtherTypeIPv4) {
+    return false;
+  }
+  *mac_address = EthernetHeader::Destination::load(data);
+  if ((mac_address->ether_addr_octet[0] & 0x01u) != 0) {
+    // broadcast or multicast
+    return false;
+  }
+  *ip_address =
+      IPv4Header::Destination::load(data + EthernetHeader::kLength);
+  return true;
+}
+
+} // namespace
+
+ReplayDevice::ReplayDevice(const char *device_name, MacAddress mac_address,
+                           IPAddress ip_address, int timer_fd)
+    : Device(device_name, mac_address, ip_address), timer_fd_(timer_fd),
+      trace_(), rx_buffer_(new char[kEtherFrameLengthMax]),
+      timing_(ReplayTiming::FAST), speed_(1), loops_(1), loop_(0), next_(0),
+      loop_start_(0), start_(0), end_(0), replayed_(0), sent_(0),
+      profile_() {}
+
+ReplayDevice::~ReplayDevice() { __real_close(timer_fd_); }
+
+std::unique_ptr<ReplayDevice>
+ReplayDevice::create(const char *device_name, const DeviceConfig &config) {
+  if (config.replay_timing == ReplayTiming::SCALED &&
+      !(config.replay_speed > 0)) {
+    LOG(ERROR) << "bad replay speed " << config.replay_speed;
+    return nullptr;
+  }
+
+  Trace trace;
+  if (!load(config.replay_file, &trace)) {
+    return nullptr;
+  }
+
+  MacAddress mac_address = config.mac_address;
+  IPAddress ip_address = config.ip_address;
+  for (const Frame &frame : trace.frames) {
+    ether_addr mac;
+    in_addr ip;
+    if (findDestination(trace.data.data() + frame.offset, frame.length, &mac,
+                        &ip)) {
+      if (!mac_address.isSpecified()) {
+        mac_address = MacAddress(mac);
+      }
+      if (!ip_address.isSpecified()) {
+        ip_address = IPAddress(ip);
+      }
+      break;
+    }
+  }
+  if (!mac_address.isSpecified() || !ip_address.isSpecified()) {
+    LOG(ERROR) << "no IPv4 frame to take the addresses from: "
+               << config.replay_file;
+    return nullptr;
+  }
+
+  int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timer_fd < 0) {
+    LOG(ERROR) << "timerfd_create failed " << strerror(errno);
+    return nullptr;
+  }
+
+  std::unique_ptr<ReplayDevice> device(
+      new ReplayDevice(device_name, mac_address, ip_address, timer_fd));
+  device->trace_ = std::move(trace);
+  device->timing_ = config.replay_timing;
+  device->speed_ =
+      config.replay_timing == ReplayTiming::SCALED ? config.replay_speed : 1;
+  device->loops_ = std::max<size_t>(config.replay_loops, 1);
+  LOG(INFO) << device_name << " replays " << device->trace_.frames.size()
+            << " frames " << device->loops_ << " times";
+  return device;
+}
+
+bool ReplayDevice::load(const std::string &file, Trace *trace) {
+  char errbuf[PCAP_ERRBUF_SIZE];
+  pcap_t *pcap = pcap_open_offline(file.c_str(), errbuf);
+  if (pcap == nullptr) {
+    LOG(ERROR) << errbuf;
+    return false;
+  }
+  if (pcap_datalink(pcap) != DLT_EN10MB) {
+    LOG(ERROR) << file << " is not IEEE 802.3 Ethernet";
+    pcap_close(pcap);
+    return false;
+  }
+
+  pcap_pkthdr *header;
+  const u_char *data;
+  uint64_t first = 0;
+  size_t skipped = 0;
+  int rv;
+  while ((rv = pcap_next_ex(pcap, &header, &data)) == 1) {
+    if (header->caplen > kEtherFrameLengthMax) {
+      skipped++;
+      continue;
+    }
+    uint64_t time = header->ts.tv_sec * kNanosecondsPerSecond +
+                    header->ts.tv_usec * 1000;
+    if (trace->frames.empty()) {
+      first = time;
+    }
+    trace->frames.push_back(
+        {trace->data.size(), header->caplen, time < first ? 0 : time - first});
+    trace->data.insert(trace->data.end(), data, data + header->caplen);
+  }
+  if (rv == PCAP_ERROR) {
+    LOG(ERROR) << pcap_geterr(pcap);
+  }
+  pcap_close(pcap);
+
+  if (skipped != 0) {
+    LOG(INFO) << "skip " << skipped << " frames longer than the MTU";
+  }
+  if (rv == PCAP_ERROR || trace->frames.empty()) {
+    LOG(ERROR) << "no frame to replay in " << file;
+    return false;
+  }
+  return true;
+}
+
+bool ReplayDevice::registerTo(EpollServer *server) {
+  if (!Device::registerTo(server)) {
+    return false;
+  }
+  start_ = monotonicNow();
+  loop_start_ = start_;
+  if (!finished()) {
+    arm(timing_ == ReplayTiming::FAST ? 0 : loop_start_);
+  }
+  return true;
+}
+
+uint64_t ReplayDevice::dueTime(const Frame &frame) const {
+  return loop_start_ + static_cast<uint64_t>(frame.time / speed_);
+}
+
+void ReplayDevice::arm(uint64_t time) {
+  itimerspec spec{};
+  if (time == 0) {
+    // an absolute time in the past expires at once
+    spec.it_value.tv_nsec = 1;
+  } else {
+    spec.it_value.tv_sec = time / kNanosecondsPerSecond;
+    spec.it_value.tv_nsec = time % kNanosecondsPerSecond;
+  }
+  if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+    LOG(ERROR) << "timerfd_settime failed " << strerror(errno);
+  }
+}
+
+/**
+ * @brief Inject the frames that are due, at most |kReplayBudget| of them,
+ * and arm the timer for the next one.
+ */
+void ReplayDevice::onReadable() {
+  uint64_t expirations;
+  __real_read(timer_fd_, &expirations, sizeof(expirations));
+  if (finished()) {
+    return;
+  }
+
+  uint64_t now = monotonicNow();
+  profile_.activate();
+  for (int i = 0; i < kReplayBudget && !finished(); i++) {
+    const Frame &frame = trace_.frames[next_];
+    if (timing_ != ReplayTiming::FAST && dueTime(frame) > now) {
+      break;
+    }
+    // the layers may write to the frame, keep the trace intact
+    memcpy(rx_buffer_.get(), trace_.data.data() + frame.offset, frame.length);
+    decodeFrame(rx_buffer_.get(), frame.length);
+    replayed_++;
+
+    if (++next_ == trace_.frames.size()) {
+      next_ = 0;
+      loop_++;
+      loop_start_ = now;
+    }
+  }
+  profile_.deactivate();
+
+  if (!finished()) {
+    arm(timing_ == ReplayTiming::FAST ? 0 : dueTime(trace_.frames[next_]));
+    return;
+  }
+  end_ = monotonicNow();
+  std::ostringstream os;
+  dumpStats(os);
+  LOG(INFO) << getDeviceName() << " is done\n" << os.str();
+}
+
+void ReplayDevice::sendFrameWithHeader(const char * /*header*/,
+                                       char * /*buf*/, size_t /*len*/) {
+  sent_++;
+}
+
+void ReplayDevice::dumpStats(std::ostream &os) const {
+  uint64_t elapsed = (finished() ? end_ : monotonicNow()) - start_;
+  double pps = elapsed == 0 ? 0 : replayed_ * 1e9 / elapsed;
+  os << "replayed " << replayed_ << " frames in " << elapsed / 1000
+     << "us pps=" << pps << " sent=" << sent_ << "\n";
+  profile_.dump(os);
+}
@@ -0,0 +1,97 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_ETHER_REPLAY_DEVICE_H
+#define SRC_ETHER_REPLAY_DEVICE_H
+
+#include "../base/layer_profile.h"
+#include "device.h"
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief A device receiving the frames of a pcap file.
+ * The trace is read into memory when the device is created, so the replay
+ * measures the stack and not the disk. A timerfd registered to the
+ * EpollServer paces the frames as |DeviceConfig::replay_timing| says, each
+ * wakeup hands a batch of due frames to the callback. Frames sent by the
+ * stack are only counted.
+ *
+ * The layers are profiled while the frames are injected, the device logs
+ * the throughput of every layer when the last loop is done.
+ */
+class ReplayDevice : public Device {
+public:
+  DISALLOW_COPY_AND_ASSIGN(ReplayDevice)
+  ~ReplayDevice() override;
+
+  /**
+   * @brief Load the trace of |config.replay_file|.
+   * @return nullptr if the file cannot be read or has no Ethernet frame
+   */
+  static std::unique_ptr<ReplayDevice> create(const char *device_name,
+                                              const DeviceConfig &config);
+
+  using Device::sendFrame;
+  void sendFrame(char *buf, size_t len, MacAddress dst) override {
+    encodeAndSend(buf, len, dst);
+  }
+  void sendFrameWithHeader(const char *header, char *buf,
+                           size_t len) override;
+
+  void onReadable() override;
+
+  int getFd() override { return timer_fd_; }
+
+  // Register the timer and start the replay.
+  bool registerTo(EpollServer *server) override;
+
+  inline bool finished() const { return loop_ == loops_; }
+
+  inline const LayerProfile &profile() const { return profile_; }
+
+  // Print the frames replayed, their rate and the profile of the layers.
+  void dumpStats(std::ostream &os) const;
+
+private:
+  struct Frame {
+    size_t offset;
+    size_t length;
+    // nanoseconds since the first frame of the trace
+    uint64_t time;
+  };
+
+  struct Trace {
+    std::vector<char> data;
+    std::vector<Frame> frames;
+  };
+
+  ReplayDevice(const char *device_name, MacAddress mac_address,
+               IPAddress ip_address, int timer_fd);
+
+  static bool load(const std::string &file, Trace *trace);
+
+  uint64_t dueTime(const Frame &frame) const;
+  // Expire the timer at |time|, at once if it is 0.
+  void arm(uint64_t time);
+
+  int timer_fd_;
+  Trace trace_;
+  std::unique_ptr<char[]> rx_buffer_;
+  ReplayTiming timing_;
+  double speed_;
+
+  size_t loops_;
+  size_t loop_;
+  // the next frame of the current loop
+  size_t next_;
+  uint64_t loop_start_;
+  uint64_t start_;
+  uint64_t end_;
+  uint64_t replayed_;
+  uint64_t sent_;
+  LayerProfile profile_;
+};
+
+#endif // SRC_ETHER_REPLAY_DEVICE_H
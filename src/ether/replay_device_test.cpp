@@ -0,0 +1,138 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "replay_device.h"
+#include "../ip/ipv4_header.h"
+#include "ethernet_header.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <poll.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+class FrameCounter : public IDeviceCallback {
+public:
+  void onReceive(Device * /*device*/, char * /*buf*/,
+                 size_t /*len*/) override {
+    frames++;
+  }
+
+  int frames = 0;
+};
+
+struct TraceFrame {
+  const char *destination;
+  const char *ip_address;
+  uint16_t type;
+  uint32_t milliseconds;
+};
+
+// Write a pcap file of minimal Ethernet frames.
+void writeTrace(const std::string &path, const std::vector<TraceFrame> &trace) {
+  FILE *file = fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  const uint32_t header[] = {0xa1b2c3d4, 0x00040002, 0, 0, 65535, 1};
+  fwrite(header, sizeof(header), 1, file);
+
+  for (const TraceFrame &item : trace) {
+    char frame[EthernetHeader::kLength + IPv4Header::kLength] = {};
+    EthernetHeader::Destination::store(frame,
+                                       MacAddress(item.destination).address());
+    EthernetHeader::Type::store(frame, item.type);
+    char *packet = frame + EthernetHeader::kLength;
+    IPv4Header::VersionAndLength::store(packet, 0x45);
+    IPv4Header::TotalLength::store(packet, IPv4Header::kLength);
+    IPv4Header::Destination::store(packet,
+                                   IPAddress(item.ip_address).toInAddr());
+
+    const uint32_t record[] = {item.milliseconds / 1000,
+                               item.milliseconds % 1000 * 1000, sizeof(frame),
+                               sizeof(frame)};
+    fwrite(record, sizeof(record), 1, file);
+    fwrite(frame, sizeof(frame), 1, file);
+  }
+  fclose(file);
+}
+
+bool waitReadable(Device *device, int timeout) {
+  pollfd event{device->getFd(), POLLIN, 0};
+  return poll(&event, 1, timeout) == 1;
+}
+
+class ReplayDeviceTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "replay-test-" +
+            std::to_string(getpid()) + ".pcap";
+    config_.type = DeviceType::REPLAY;
+    config_.replay_file = path_;
+  }
+
+  void TearDown() override { unlink(path_.c_str()); }
+
+  std::string path_;
+  DeviceConfig config_;
+};
+
+} // namespace
+
+TEST_F(ReplayDeviceTest, Fast) {
+  writeTrace(path_, {{"02:00:00:00:00:01", "10.0.0.1", kEtherTypeIPv4, 0},
+                     {"02:00:00:00:00:02", "10.0.0.2", kEtherTypeIPv4, 1},
+                     {"02:00:00:00:00:01", "10.0.0.1", kEtherTypeIPv4, 2}});
+  config_.replay_loops = 3;
+  auto device = ReplayDevice::create("replay", config_);
+  ASSERT_NE(device, nullptr);
+  // the addresses of the first IPv4 frame
+  EXPECT_EQ(device->getIpAddress(), IPAddress("10.0.0.1"));
+  EXPECT_EQ(device->getMacAddress(), MacAddress("02:00:00:00:00:01"));
+
+  FrameCounter counter;
+  device->setCallback(&counter);
+  EpollServer server;
+  ASSERT_TRUE(device->registerTo(&server));
+
+  while (!device->finished()) {
+    ASSERT_TRUE(waitReadable(device.get(), 1000));
+    device->onReadable();
+  }
+  // the frames to another host are dropped by the link layer
+  EXPECT_EQ(counter.frames, 6);
+  EXPECT_EQ(device->profile().packets(LayerProfile::LINK), 9);
+  // the cycles of every scope add up, none is rounded to zero
+  EXPECT_GT(device->profile().nanoseconds(LayerProfile::LINK), 0);
+}
+
+TEST_F(ReplayDeviceTest, OriginalTiming) {
+  writeTrace(path_, {{"02:00:00:00:00:01", "10.0.0.1", kEtherTypeIPv4, 0},
+                     {"02:00:00:00:00:01", "10.0.0.1", kEtherTypeIPv4, 200}});
+  config_.replay_timing = ReplayTiming::ORIGINAL;
+  auto device = ReplayDevice::create("replay", config_);
+  ASSERT_NE(device, nullptr);
+
+  FrameCounter counter;
+  device->setCallback(&counter);
+  EpollServer server;
+  ASSERT_TRUE(device->registerTo(&server));
+
+  ASSERT_TRUE(waitReadable(device.get(), 1000));
+  device->onReadable();
+  EXPECT_EQ(counter.frames, 1);
+  EXPECT_FALSE(device->finished());
+
+  ASSERT_TRUE(waitReadable(device.get(), 1000));
+  device->onReadable();
+  EXPECT_EQ(counter.frames, 2);
+  EXPECT_TRUE(device->finished());
+}
+
+TEST_F(ReplayDeviceTest, BadTrace) {
+  EXPECT_EQ(ReplayDevice::create("replay", config_), nullptr);
+
+  // nothing to take the addresses from
+  writeTrace(path_, {{"ff:ff:ff:ff:ff:ff", "0.0.0.0", kEtherTypeARP, 0}});
+  EXPECT_EQ(ReplayDevice::create("replay", config_), nullptr);
+}
@@ -0,0 +1,201 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "tap_device.h"
+#include "../ip/ipv4_header.h"
+#include "../posix/wrap_function.h"
+#include "./ethernet_header.h"
+#include "./type.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <linux/if_tun.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+// frames read from one queue per callback, the fd stays readable after it
+const int kReadBudget = 64;
+// short frames are padded up to the minimum Ethernet payload
+const char kPadding[kEtherDataLengthMin] = {};
+
+} // namespace
+
+TapDevice::Queue::~Queue() { __real_close(fd_); }
+
+TapDevice::TapDevice(const char *device_name, MacAddress mac_address,
+                     IPAddress ip_address)
+    : Device(device_name, mac_address, ip_address), queues_() {}
+
+TapDevice::~TapDevice() = default;
+
+std::unique_ptr<TapDevice> TapDevice::create(const char *device_name,
+                                             const DeviceConfig &config) {
+  if (strlen(device_name) >= IFNAMSIZ) {
+    LOG(ERROR) << "The name is too long: " << device_name;
+    return nullptr;
+  }
+  if (!config.ip_address.isSpecified()) {
+    LOG(ERROR) << "no IP address for " << device_name;
+    return nullptr;
+  }
+
+  MacAddress mac_address = config.mac_address;
+  if (!mac_address.isSpecified()) {
+    mac_address = MacAddress::random();
+  }
+  std::unique_ptr<TapDevice> device(
+      new TapDevice(device_name, mac_address, config.ip_address));
+
+  const size_t queue_count = std::max<size_t>(config.queue_count, 1);
+  for (size_t i = 0; i < queue_count; i++) {
+    int fd = openQueue(device_name, queue_count > 1);
+    if (fd < 0) {
+      return nullptr;
+    }
+    device->queues_.push_back(std::make_unique<Queue>(device.get(), fd));
+  }
+
+  if (!bringUp(device_name)) {
+    return nullptr;
+  }
+  return device;
+}
+
+int TapDevice::openQueue(const char *device_name, bool multi_queue) {
+  int fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    LOG(ERROR) << "open /dev/net/tun failed " << strerror(errno);
+    return -1;
+  }
+
+  ifreq ifr{};
+  strncpy(ifr.ifr_name, device_name, IFNAMSIZ - 1);
+  ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+  if (multi_queue) {
+    ifr.ifr_flags |= IFF_MULTI_QUEUE;
+  }
+  if (ioctl(fd, TUNSETIFF, &ifr) < 0) {
+    LOG(ERROR) << "TUNSETIFF failed " << strerror(errno) << ": "
+               << device_name;
+    __real_close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool TapDevice::bringUp(const char *device_name) {
+  int fd = __real_socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    LOG(ERROR) << "socket failed " << strerror(errno);
+    return false;
+  }
+
+  ifreq ifr{};
+  strncpy(ifr.ifr_name, device_name, IFNAMSIZ - 1);
+  bool rv = ioctl(fd, SIOCGIFFLAGS, &ifr) == 0;
+  if (rv && (ifr.ifr_flags & IFF_UP) == 0) {
+    ifr.ifr_flags |= IFF_UP;
+    rv = ioctl(fd, SIOCSIFFLAGS, &ifr) == 0;
+  }
+  if (!rv) {
+    LOG(ERROR) << "bringing up the interface failed " << strerror(errno)
+               << ": " << device_name;
+  }
+  __real_close(fd);
+  return rv;
+}
+
+bool TapDevice::registerTo(EpollServer *server) {
+  for (auto &queue : queues_) {
+    if (!server->registerRead(queue->fd(), queue.get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TapDevice::registerQueues(EpollServerGroup *readers) {
+  size_t first = readers->nextIndex();
+  for (size_t i = 0; i < queues_.size(); i++) {
+    EpollServer *server = readers->getServer((first + i) % readers->size());
+    if (!server->registerRead(queues_[i]->fd(), queues_[i].get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Hash the addresses and, for TCP and UDP, the ports of an IPv4
+ * packet. Other frames, e.g. ARP, take the first queue.
+ */
+TapDevice::Queue *TapDevice::selectQueue(const char *header, const char *buf,
+                                         size_t len) {
+  if (queues_.size() == 1 || len < IPv4Header::kLength ||
+      EthernetHeader::Type::load(header) != kEtherTypeIPv4) {
+    return queues_.front().get();
+  }
+
+  uint32_t hash = IPv4Header::Source::load(buf).s_addr ^
+                  IPv4Header::Destination::load(buf).s_addr;
+  size_t header_length = (IPv4Header::VersionAndLength::load(buf) & 0xfu) * 4;
+  uint8_t protocol = IPv4Header::Protocol::load(buf);
+  if ((protocol == IPPROTO_TCP || protocol == IPPROTO_UDP) &&
+      len >= header_length + sizeof(uint32_t)) {
+    uint32_t ports;
+    memcpy(&ports, buf + header_length, sizeof(ports));
+    hash ^= ports;
+  }
+  // fold the bytes, the low bits of the addresses of a subnet are alike
+  hash ^= hash >> 16u;
+  hash ^= hash >> 8u;
+  return queues_[hash % queues_.size()].get();
+}
+
+void TapDevice::sendFrameWithHeader(const char *header, char *buf,
+                                    size_t len) {
+  if (len > kEtherDataLengthMax) {
+    LOG(ERROR) << "frame is too long: " << len;
+    return;
+  }
+
+  iovec iov[3] = {
+      {const_cast<char *>(header), kEtherHeaderLength}, {buf, len}, {}};
+  int count = 2;
+  if (len < kEtherDataLengthMin) {
+    iov[2].iov_base = const_cast<char *>(kPadding);
+    iov[2].iov_len = kEtherDataLengthMin - len;
+    count = 3;
+  }
+
+  if (writev(selectQueue(header, buf, len)->fd(), iov, count) < 0) {
+    LOG(ERROR) << "writev failed " << strerror(errno) << ": "
+               << getDeviceName();
+  }
+}
+
+void TapDevice::onReadable() {
+  for (auto &queue : queues_) {
+    queue->onReadable();
+  }
+}
+
+void TapDevice::receive(int fd, char *buffer) {
+  for (int i = 0; i < kReadBudget; i++) {
+    ssize_t rv = __real_read(fd, buffer, kEtherFrameLengthMax);
+    if (rv < 0) {
+      if (errno != EAGAIN && errno != EINTR) {
+        LOG(ERROR) << "read failed " << strerror(errno) << ": "
+                   << getDeviceName();
+      }
+      return;
+    }
+    decodeFrame(buffer, rv);
+  }
+}
@@ -0,0 +1,85 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_ETHER_TAP_DEVICE_H
+#define SRC_ETHER_TAP_DEVICE_H
+
+#include "device.h"
+#include <vector>
+
+/**
+ * @brief The far end of a TAP interface.
+ * The kernel sees a host behind the interface, and that host is the stack.
+ * So the stack keeps its own addresses and the NIC can stay with the
+ * kernel, which routes to the TAP. A tun file descriptor moves one frame
+ * per syscall: frames are read until the queue is empty and written with
+ * writev, which gathers the header and the payload without a copy.
+ *
+ * With several queues the interface is opened with IFF_MULTI_QUEUE and
+ * the kernel spreads the flows over the queues. Each queue is its own
+ * EpollCallback with a buffer of its own, so the queues are read in
+ * parallel if the device is registered to an EpollServerGroup. A frame
+ * is sent through the queue of its flow, the frames of a flow keep their
+ * order.
+ */
+class TapDevice : public Device {
+public:
+  DISALLOW_COPY_AND_ASSIGN(TapDevice)
+  ~TapDevice() override;
+
+  /**
+   * @brief Open or create the interface and bring it up.
+   * @return nullptr on failure, e.g. without CAP_NET_ADMIN
+   */
+  static std::unique_ptr<TapDevice> create(const char *device_name,
+                                           const DeviceConfig &config);
+
+  using Device::sendFrame;
+  void sendFrame(char *buf, size_t len, MacAddress dst) override {
+    encodeAndSend(buf, len, dst);
+  }
+  void sendFrameWithHeader(const char *header, char *buf,
+                           size_t len) override;
+
+  // Drain all queues.
+  void onReadable() override;
+
+  int getFd() override { return queues_.front()->fd(); }
+
+  bool registerTo(EpollServer *server) override;
+
+protected:
+  // Register the queues to consecutive loops of |readers|.
+  bool registerQueues(EpollServerGroup *readers) override;
+
+private:
+  class Queue : public EpollCallback {
+  public:
+    Queue(TapDevice *device, int fd)
+        : device_(device), fd_(fd), buffer_(new char[kEtherFrameLengthMax]) {}
+    ~Queue();
+
+    void onReadable() override { device_->receive(fd_, buffer_.get()); }
+
+    inline int fd() const { return fd_; }
+
+  private:
+    TapDevice *device_;
+    int fd_;
+    std::unique_ptr<char[]> buffer_;
+  };
+
+  TapDevice(const char *device_name, MacAddress mac_address,
+            IPAddress ip_address);
+
+  static int openQueue(const char *device_name, bool multi_queue);
+  static bool bringUp(const char *device_name);
+  void receive(int fd, char *buffer);
+  // The queue sending the frame of |header| and |buf|.
+  Queue *selectQueue(const char *header, const char *buf, size_t len);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+};
+
+#endif // SRC_ETHER_TAP_DEVICE_H
@@ -10,6 +10,9 @@ const size_t kEtherDataLengthMax = 1500;
 const size_t kMacAddressLength = 6;
 const size_t kEtherHeaderLength = kMacAddressLength * 2 + 2;
 
+const uint16_t kEtherTypeIPv4 = 0x0800;
+const uint16_t kEtherTypeARP = 0x0806;
+
 /* no worry for frame check sequence, because the hardware computes that for
  * us*/
 const size_t kEtherChecksumLength = 4;
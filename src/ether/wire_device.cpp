@@ -0,0 +1,457 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "wire_device.h"
+#include "../posix/wrap_function.h"
+#include "./ethernet_header.h"
+#include "./type.h"
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+const uint32_t kWireMagic = 0x57495245;
+const size_t kCacheLineSize = 64;
+// the length of a frame followed by the frame
+const size_t kSlotSize = 2048;
+const size_t kFrameOffset = 8;
+static_assert(kFrameOffset + kEtherFrameLengthMax <= kSlotSize,
+              "a slot holds a whole frame");
+
+// how long to wait for the creator of a wire to set it up
+const int kWaitRounds = 1000;
+const useconds_t kWaitInterval = 1000;
+
+enum PortState : uint32_t {
+  kPortFree = 0,
+  kPortClaimed = 1,
+  kPortReady = 2,
+};
+
+bool waitForSize(int fd, size_t size) {
+  for (int i = 0; i < kWaitRounds; i++) {
+    struct stat status {};
+    if (fstat(fd, &status) < 0) {
+      LOG(ERROR) << "fstat failed " << strerror(errno);
+      return false;
+    }
+    if (static_cast<size_t>(status.st_size) == size) {
+      return true;
+    }
+    if (status.st_size != 0) {
+      LOG(ERROR) << "the wire has " << status.st_size << " bytes, not "
+                 << size;
+      return false;
+    }
+    usleep(kWaitInterval);
+  }
+  LOG(ERROR) << "the wire is never set up";
+  return false;
+}
+
+// Duplicate the file descriptor |fd| of the process |pid|.
+int duplicateFd(int pid, int fd) {
+  if (pid == getpid()) {
+    int rv = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (rv < 0) {
+      LOG(ERROR) << "fcntl failed " << strerror(errno);
+    }
+    return rv;
+  }
+
+  int pid_fd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+  if (pid_fd < 0) {
+    LOG(ERROR) << "pidfd_open failed " << strerror(errno) << ": " << pid;
+    return -1;
+  }
+  int rv = static_cast<int>(syscall(SYS_pidfd_getfd, pid_fd, fd, 0));
+  if (rv < 0) {
+    LOG(ERROR) << "pidfd_getfd failed " << strerror(errno) << ": " << pid;
+  }
+  __real_close(pid_fd);
+  return rv;
+}
+
+} // namespace
+
+const size_t WireDevice::kMaxPorts;
+
+// The state of a port, written by its owner and read by the peers.
+struct WireDevice::Port {
+  alignas(kCacheLineSize) uint32_t state;
+  // bumped by every attach, so the peers renew their eventfd
+  uint32_t generation;
+  int32_t pid;
+  int32_t event_fd;
+  ether_addr mac_address;
+};
+
+// The indices of a ring, followed by its slots.
+struct WireDevice::Ring {
+  alignas(kCacheLineSize) uint32_t producer;
+  alignas(kCacheLineSize) uint32_t consumer;
+};
+
+// The head of the shared memory object, followed by the rings.
+struct WireDevice::Wire {
+  uint32_t magic;
+  uint32_t port_count;
+  uint32_t slot_count;
+  Port ports[kMaxPorts];
+};
+
+WireDevice::WireDevice(const char *device_name, MacAddress mac_address,
+                       IPAddress ip_address, int event_fd)
+    : Device(device_name, mac_address, ip_address), event_fd_(event_fd),
+      wire_(nullptr), wire_size_(0), port_count_(0), slot_count_(0),
+      ring_size_(0), port_(kMaxPorts), tx_producers_(), tx_pending_(0),
+      tx_batch_(1), peers_() {}
+
+WireDevice::~WireDevice() {
+  if (wire_ != nullptr) {
+    if (port_ != kMaxPorts) {
+      flush();
+      __atomic_store_n(&wire_->ports[port_].state, kPortFree,
+                       __ATOMIC_RELEASE);
+    }
+    munmap(wire_, wire_size_);
+  }
+  for (Peer &peer : peers_) {
+    if (peer.fd >= 0) {
+      __real_close(peer.fd);
+    }
+  }
+  __real_close(event_fd_);
+}
+
+std::unique_ptr<WireDevice> WireDevice::create(const char *device_name,
+                                               const DeviceConfig &config) {
+  if (!config.ip_address.isSpecified()) {
+    LOG(ERROR) << "no IP address for " << device_name;
+    return nullptr;
+  }
+  if (config.port_count < 2 || config.port_count > kMaxPorts) {
+    LOG(ERROR) << "a wire has 2 to " << kMaxPorts << " ports, not "
+               << config.port_count;
+    return nullptr;
+  }
+
+  int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd < 0) {
+    LOG(ERROR) << "eventfd failed " << strerror(errno);
+    return nullptr;
+  }
+
+  MacAddress mac_address = config.mac_address;
+  if (!mac_address.isSpecified()) {
+    mac_address = MacAddress::random();
+  }
+  std::unique_ptr<WireDevice> device(
+      new WireDevice(device_name, mac_address, config.ip_address, event_fd));
+  if (!device->mapWire(config) || !device->attach()) {
+    return nullptr;
+  }
+  return device;
+}
+
+/**
+ * @brief Create the shared memory object, or map it and wait until its
+ * creator has set it up. The geometry must agree with |config|.
+ */
+bool WireDevice::mapWire(const DeviceConfig &config) {
+  port_count_ = config.port_count;
+  slot_count_ = 2;
+  while (slot_count_ < config.slot_count) {
+    slot_count_ <<= 1u;
+  }
+  ring_size_ = sizeof(Ring) + slot_count_ * kSlotSize;
+  wire_size_ = sizeof(Wire) + port_count_ * port_count_ * ring_size_;
+  tx_batch_ = std::max<size_t>(config.tx_batch, 1);
+  tx_producers_.resize(port_count_);
+  peers_.resize(port_count_);
+
+  std::string name = "/" + getDeviceName();
+  bool created = true;
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    created = false;
+    fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+  }
+  if (fd < 0) {
+    LOG(ERROR) << "shm_open failed " << strerror(errno) << ": " << name;
+    return false;
+  }
+
+  if (created && ftruncate(fd, wire_size_) < 0) {
+    LOG(ERROR) << "ftruncate failed " << strerror(errno) << ": " << name;
+    __real_close(fd);
+    return false;
+  }
+  if (!created && !waitForSize(fd, wire_size_)) {
+    __real_close(fd);
+    return false;
+  }
+  void *map =
+      mmap(nullptr, wire_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  __real_close(fd);
+  if (map == MAP_FAILED) {
+    LOG(ERROR) << "mmap failed " << strerror(errno) << ": " << name;
+    return false;
+  }
+  wire_ = static_cast<Wire *>(map);
+
+  if (created) {
+    wire_->port_count = port_count_;
+    wire_->slot_count = slot_count_;
+    __atomic_store_n(&wire_->magic, kWireMagic, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  for (int i = 0; __atomic_load_n(&wire_->magic, __ATOMIC_ACQUIRE) !=
+                  kWireMagic;
+       i++) {
+    if (i == kWaitRounds) {
+      LOG(ERROR) << "the wire is never set up: " << name;
+      return false;
+    }
+    usleep(kWaitInterval);
+  }
+  if (wire_->port_count != port_count_ || wire_->slot_count != slot_count_) {
+    LOG(ERROR) << "the wire has " << wire_->port_count << " ports of "
+               << wire_->slot_count << " slots: " << name;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Take a free port, or the port of a process gone without detaching,
+ * and drop the frames left for its previous owner.
+ */
+bool WireDevice::attach() {
+  for (size_t i = 0; i < port_count_ && port_ == kMaxPorts; i++) {
+    Port &port = wire_->ports[i];
+    uint32_t state = kPortFree;
+    if (__atomic_compare_exchange_n(&port.state, &state, kPortClaimed, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      port_ = i;
+    } else if (state == kPortReady && kill(port.pid, 0) < 0 &&
+               errno == ESRCH &&
+               __atomic_compare_exchange_n(&port.state, &state, kPortClaimed,
+                                           false, __ATOMIC_ACQ_REL,
+                                           __ATOMIC_ACQUIRE)) {
+      port_ = i;
+    }
+  }
+  if (port_ == kMaxPorts) {
+    LOG(ERROR) << "no free port on " << getDeviceName();
+    return false;
+  }
+
+  for (size_t i = 0; i < port_count_; i++) {
+    if (i == port_) {
+      continue;
+    }
+    Ring *in = ringOf(i, port_);
+    __atomic_store_n(&in->consumer,
+                     __atomic_load_n(&in->producer, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+    tx_producers_[i] =
+        __atomic_load_n(&ringOf(port_, i)->producer, __ATOMIC_RELAXED);
+  }
+
+  Port &port = wire_->ports[port_];
+  port.generation++;
+  port.pid = getpid();
+  port.event_fd = event_fd_;
+  port.mac_address = getMacAddress().address();
+  __atomic_store_n(&port.state, kPortReady, __ATOMIC_RELEASE);
+  LOG(INFO) << getDeviceName() << " takes port " << port_;
+  return true;
+}
+
+WireDevice::Ring *WireDevice::ringOf(size_t from, size_t to) {
+  char *base = reinterpret_cast<char *>(wire_ + 1);
+  return reinterpret_cast<Ring *>(base +
+                                  (from * port_count_ + to) * ring_size_);
+}
+
+char *WireDevice::slotOf(Ring *ring, uint32_t index) {
+  char *slots = reinterpret_cast<char *>(ring + 1);
+  return slots + (index & (slot_count_ - 1)) * kSlotSize;
+}
+
+size_t WireDevice::findPort(MacAddress address) {
+  if (address.isBroadcast()) {
+    return port_count_;
+  }
+  for (size_t i = 0; i < port_count_; i++) {
+    const Port &port = wire_->ports[i];
+    if (i != port_ &&
+        __atomic_load_n(&port.state, __ATOMIC_ACQUIRE) == kPortReady &&
+        MacAddress(port.mac_address) == address) {
+      return i;
+    }
+  }
+  return port_count_;
+}
+
+void WireDevice::sendFrameWithHeader(const char *header, char *buf,
+                                     size_t len) {
+  if (len > kEtherDataLengthMax) {
+    LOG(ERROR) << "frame is too long: " << len;
+    return;
+  }
+
+  size_t to = findPort(MacAddress(EthernetHeader::Destination::load(header)));
+  if (to != port_count_) {
+    push(to, header, buf, len);
+    return;
+  }
+  for (size_t i = 0; i < port_count_; i++) {
+    if (i != port_ && __atomic_load_n(&wire_->ports[i].state,
+                                      __ATOMIC_ACQUIRE) == kPortReady) {
+      push(i, header, buf, len);
+    }
+  }
+}
+
+void WireDevice::push(size_t to, const char *header, const char *buf,
+                      size_t len) {
+  Ring *ring = ringOf(port_, to);
+  uint32_t producer = tx_producers_[to];
+  if (producer - __atomic_load_n(&ring->consumer, __ATOMIC_ACQUIRE) >=
+      slot_count_) {
+    // let the receiver catch up
+    publish(to);
+    LOG(ERROR) << "the ring to port " << to
+               << " is full, drop a frame: " << getDeviceName();
+    return;
+  }
+
+  // a virtual wire has no minimum frame length, so there is no padding
+  char *slot = slotOf(ring, producer);
+  char *frame = slot + kFrameOffset;
+  memcpy(frame, header, kEtherHeaderLength);
+  memcpy(frame + kEtherHeaderLength, buf, len);
+  *reinterpret_cast<uint32_t *>(slot) = kEtherHeaderLength + len;
+  tx_producers_[to] = producer + 1;
+
+  if (++tx_pending_ >= tx_batch_) {
+    flush();
+  }
+}
+
+void WireDevice::flush() {
+  if (tx_pending_ == 0) {
+    return;
+  }
+  tx_pending_ = 0;
+  for (size_t i = 0; i < port_count_; i++) {
+    if (i != port_) {
+      publish(i);
+    }
+  }
+}
+
+/**
+ * @brief The fence pairs with the one in |onReadable|: either the receiver
+ * sees the new frames after draining the ring, or we see that it has
+ * drained the ring and wake it up.
+ */
+void WireDevice::publish(size_t to) {
+  Ring *ring = ringOf(port_, to);
+  uint32_t published = __atomic_load_n(&ring->producer, __ATOMIC_RELAXED);
+  if (tx_producers_[to] == published) {
+    return;
+  }
+  __atomic_store_n(&ring->producer, tx_producers_[to], __ATOMIC_RELEASE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&ring->consumer, __ATOMIC_RELAXED) == published) {
+    wake(to);
+  }
+}
+
+void WireDevice::wake(size_t to) {
+  const Port &port = wire_->ports[to];
+  if (__atomic_load_n(&port.state, __ATOMIC_ACQUIRE) != kPortReady) {
+    return;
+  }
+
+  Peer &peer = peers_[to];
+  if (peer.generation != port.generation) {
+    if (peer.fd >= 0) {
+      __real_close(peer.fd);
+    }
+    peer.generation = port.generation;
+    peer.fd = duplicateFd(port.pid, port.event_fd);
+  }
+  if (peer.fd < 0) {
+    return;
+  }
+
+  uint64_t value = 1;
+  if (__real_write(peer.fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+    LOG(ERROR) << "write eventfd failed " << strerror(errno);
+  }
+}
+
+/**
+ * @brief Drain the rings from all peers. The eventfd is reset first, so a
+ * wakeup for frames published during the drain is not lost.
+ */
+void WireDevice::onReadable() {
+  uint64_t value;
+  __real_read(event_fd_, &value, sizeof(value));
+
+  for (size_t i = 0; i < port_count_; i++) {
+    if (i != port_) {
+      receive(i);
+    }
+  }
+
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (hasFrames()) {
+    // the senders saw the rings busy, come back in the next iteration
+    value = 1;
+    __real_write(event_fd_, &value, sizeof(value));
+  }
+}
+
+void WireDevice::receive(size_t from) {
+  Ring *ring = ringOf(from, port_);
+  uint32_t consumer = __atomic_load_n(&ring->consumer, __ATOMIC_RELAXED);
+  uint32_t producer = __atomic_load_n(&ring->producer, __ATOMIC_ACQUIRE);
+  if (consumer == producer) {
+    return;
+  }
+
+  for (; consumer != producer; consumer++) {
+    char *slot = slotOf(ring, consumer);
+    decodeFrame(slot + kFrameOffset, *reinterpret_cast<uint32_t *>(slot));
+  }
+  __atomic_store_n(&ring->consumer, consumer, __ATOMIC_RELEASE);
+}
+
+bool WireDevice::hasFrames() {
+  for (size_t i = 0; i < port_count_; i++) {
+    if (i == port_) {
+      continue;
+    }
+    Ring *ring = ringOf(i, port_);
+    if (__atomic_load_n(&ring->producer, __ATOMIC_RELAXED) !=
+        __atomic_load_n(&ring->consumer, __ATOMIC_RELAXED)) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,106 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_ETHER_WIRE_DEVICE_H
+#define SRC_ETHER_WIRE_DEVICE_H
+
+#include "device.h"
+#include <vector>
+
+/**
+ * @brief A port of a virtual wire in shared memory.
+ * The devices of the same name share the POSIX shared memory object
+ * "/<name>", in one process or in several. Each attached device takes a
+ * free port, and every pair of ports has a single-producer single-consumer
+ * ring of frames in each direction. A frame goes to the port owning its
+ * destination address, broadcast and unknown destinations go to all ports.
+ *
+ * The receiver waits on an eventfd registered to the EpollServer. Senders
+ * publish their frames per |DeviceConfig::tx_batch| or flush and write the
+ * eventfd only if the receiver has drained its ring, so a busy wire runs
+ * without syscalls. Frames are handed to the callback in place.
+ *
+ * A peer in another process is signalled through a duplicate of its eventfd
+ * taken with pidfd_getfd, which needs the permission to ptrace the peer.
+ * The object outlives the devices, remove it from /dev/shm to change the
+ * geometry of the wire.
+ */
+class WireDevice : public Device {
+public:
+  DISALLOW_COPY_AND_ASSIGN(WireDevice)
+  ~WireDevice() override;
+
+  /**
+   * @brief Map or create the wire and take a free port.
+   * @return nullptr on failure, e.g. all ports are taken or the wire has a
+   * different geometry
+   */
+  static std::unique_ptr<WireDevice> create(const char *device_name,
+                                            const DeviceConfig &config);
+
+  using Device::sendFrame;
+  void sendFrame(char *buf, size_t len, MacAddress dst) override {
+    encodeAndSend(buf, len, dst);
+  }
+  void sendFrameWithHeader(const char *header, char *buf,
+                           size_t len) override;
+
+  void onReadable() override;
+
+  int getFd() override { return event_fd_; }
+
+  void flush() override;
+
+  inline size_t getPort() const { return port_; }
+
+  static const size_t kMaxPorts = 16;
+
+private:
+  struct Port;
+  struct Ring;
+  struct Wire;
+
+  // A local duplicate of the eventfd of a peer port.
+  struct Peer {
+    // |Port::generation| when |fd| was taken
+    uint32_t generation = 0;
+    int fd = -1;
+  };
+
+  WireDevice(const char *device_name, MacAddress mac_address,
+             IPAddress ip_address, int event_fd);
+
+  bool mapWire(const DeviceConfig &config);
+  bool attach();
+
+  Ring *ringOf(size_t from, size_t to);
+  char *slotOf(Ring *ring, uint32_t index);
+  // The port owning |address|, |port_count_| if there is none.
+  size_t findPort(MacAddress address);
+
+  void push(size_t to, const char *header, const char *buf, size_t len);
+  // Make the frames pushed to |to| visible and wake it up if it sleeps.
+  void publish(size_t to);
+  void wake(size_t to);
+  // Hand the frames published by |from| to the callback.
+  void receive(size_t from);
+  bool hasFrames();
+
+  int event_fd_;
+  // the mapped shared memory object
+  Wire *wire_;
+  size_t wire_size_;
+  size_t port_count_;
+  size_t slot_count_;
+  size_t ring_size_;
+  size_t port_;
+
+  // |tx_producers_[i]| is the next slot to fill on the ring to port i
+  std::vector<uint32_t> tx_producers_;
+  size_t tx_pending_;
+  size_t tx_batch_;
+  std::vector<Peer> peers_;
+};
+
+#endif // SRC_ETHER_WIRE_DEVICE_H
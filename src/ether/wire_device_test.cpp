@@ -0,0 +1,198 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "wire_device.h"
+#include "gtest/gtest.h"
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+class FrameRecorder : public IDeviceCallback {
+public:
+  void onReceive(Device *device, char *buf, size_t len) override {
+    frames.emplace_back(buf, len);
+  }
+
+  std::vector<std::string> frames;
+};
+
+bool isReadable(Device *device) {
+  pollfd event{device->getFd(), POLLIN, 0};
+  return poll(&event, 1, 0) == 1;
+}
+
+class WireDeviceTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    name_ = "wire-test-" + std::to_string(getpid());
+    shm_unlink(("/" + name_).c_str());
+    config_.type = DeviceType::WIRE;
+    config_.port_count = 3;
+    config_.slot_count = 4;
+    config_.tx_batch = 1;
+  }
+
+  void TearDown() override { shm_unlink(("/" + name_).c_str()); }
+
+  std::unique_ptr<WireDevice> attach(const char *ip_address) {
+    config_.ip_address = IPAddress(ip_address);
+    auto rv = WireDevice::create(name_.c_str(), config_);
+    if (rv != nullptr) {
+      // the clock of the neighbor table
+      rv->setEpollServer(&server_);
+    }
+    return rv;
+  }
+
+  std::string name_;
+  DeviceConfig config_;
+  EpollServer server_;
+};
+
+} // namespace
+
+TEST_F(WireDeviceTest, Unicast) {
+  auto a = attach("10.0.0.1");
+  auto b = attach("10.0.0.2");
+  auto c = attach("10.0.0.3");
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  ASSERT_NE(c, nullptr);
+  EXPECT_EQ(a->getPort(), 0);
+  EXPECT_EQ(b->getPort(), 1);
+  EXPECT_EQ(c->getPort(), 2);
+
+  FrameRecorder recorder_b, recorder_c;
+  b->setCallback(&recorder_b);
+  c->setCallback(&recorder_c);
+
+  char payload[] = "hello";
+  a->sendFrame(payload, sizeof(payload), b->getMacAddress());
+  EXPECT_TRUE(isReadable(b.get()));
+  EXPECT_FALSE(isReadable(c.get()));
+
+  b->onReadable();
+  ASSERT_EQ(recorder_b.frames.size(), 1);
+  EXPECT_STREQ(recorder_b.frames[0].c_str(), "hello");
+  EXPECT_FALSE(isReadable(b.get()));
+  EXPECT_TRUE(recorder_c.frames.empty());
+}
+
+TEST_F(WireDeviceTest, Broadcast) {
+  auto a = attach("10.0.0.1");
+  auto b = attach("10.0.0.2");
+  auto c = attach("10.0.0.3");
+  ASSERT_NE(c, nullptr);
+
+  FrameRecorder recorder_b, recorder_c;
+  b->setCallback(&recorder_b);
+  c->setCallback(&recorder_c);
+
+  char payload[] = "all";
+  a->sendFrame(payload, sizeof(payload), MacAddress::broadcastAddress());
+  b->onReadable();
+  c->onReadable();
+  EXPECT_EQ(recorder_b.frames.size(), 1);
+  EXPECT_EQ(recorder_c.frames.size(), 1);
+}
+
+TEST_F(WireDeviceTest, Batch) {
+  config_.tx_batch = 3;
+  auto a = attach("10.0.0.1");
+  auto b = attach("10.0.0.2");
+  ASSERT_NE(b, nullptr);
+
+  FrameRecorder recorder;
+  b->setCallback(&recorder);
+
+  char payload[] = "x";
+  a->sendFrame(payload, sizeof(payload), b->getMacAddress());
+  a->sendFrame(payload, sizeof(payload), b->getMacAddress());
+  // nothing is published before the batch is full or flushed
+  EXPECT_FALSE(isReadable(b.get()));
+  b->onReadable();
+  EXPECT_TRUE(recorder.frames.empty());
+
+  a->flush();
+  EXPECT_TRUE(isReadable(b.get()));
+  b->onReadable();
+  EXPECT_EQ(recorder.frames.size(), 2);
+}
+
+TEST_F(WireDeviceTest, FullRing) {
+  auto a = attach("10.0.0.1");
+  auto b = attach("10.0.0.2");
+  ASSERT_NE(b, nullptr);
+
+  FrameRecorder recorder;
+  b->setCallback(&recorder);
+
+  char payload[] = "x";
+  for (int i = 0; i < 6; i++) {
+    a->sendFrame(payload, sizeof(payload), b->getMacAddress());
+  }
+  b->onReadable();
+  EXPECT_EQ(recorder.frames.size(), 4);
+
+  // the freed slots are usable again
+  a->sendFrame(payload, sizeof(payload), b->getMacAddress());
+  b->onReadable();
+  EXPECT_EQ(recorder.frames.size(), 5);
+}
+
+TEST_F(WireDeviceTest, Ports) {
+  config_.port_count = 2;
+  auto a = attach("10.0.0.1");
+  auto b = attach("10.0.0.2");
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(attach("10.0.0.3"), nullptr);
+
+  // a detached port is taken again
+  b.reset();
+  b = attach("10.0.0.4");
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(b->getPort(), 1);
+
+  // the geometry of a wire is fixed by its creator
+  config_.slot_count = 8;
+  EXPECT_EQ(attach("10.0.0.5"), nullptr);
+}
+
+TEST_F(WireDeviceTest, ResolveNeighbor) {
+  auto a = attach("10.0.0.1");
+  auto b = attach("10.0.0.2");
+  auto c = attach("10.0.0.3");
+  ASSERT_NE(c, nullptr);
+
+  FrameRecorder recorder_a, recorder_b, recorder_c;
+  a->setCallback(&recorder_a);
+  b->setCallback(&recorder_b);
+  c->setCallback(&recorder_c);
+
+  // the packet waits for the broadcast request to be answered
+  char payload[] = "hello";
+  a->sendPacket(payload, sizeof(payload), IPAddress("10.0.0.2"));
+  EXPECT_TRUE(isReadable(c.get()));
+  c->onReadable();
+  b->onReadable();
+  a->onReadable();
+  EXPECT_FALSE(isReadable(c.get()));
+
+  b->onReadable();
+  ASSERT_EQ(recorder_b.frames.size(), 1);
+  EXPECT_STREQ(recorder_b.frames[0].c_str(), "hello");
+
+  // b has learned a from the request, nothing is broadcast any more
+  b->sendPacket(payload, sizeof(payload), IPAddress("10.0.0.1"));
+  a->sendPacket(payload, sizeof(payload), IPAddress("10.0.0.2"));
+  a->onReadable();
+  b->onReadable();
+  EXPECT_EQ(recorder_a.frames.size(), 1);
+  EXPECT_EQ(recorder_b.frames.size(), 2);
+  EXPECT_FALSE(isReadable(c.get()));
+  EXPECT_TRUE(recorder_c.frames.empty());
+}
@@ -0,0 +1,285 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "xdp_device.h"
+#include "../posix/wrap_function.h"
+#include "./type.h"
+#include <algorithm>
+#include <cstring>
+#include <glog/logging.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// the minimum chunk size of the UMEM, enough for a whole frame
+const size_t kFrameSize = 2048;
+
+bool needsWakeup(const uint32_t *flags) {
+  uint32_t value = __atomic_load_n(flags, __ATOMIC_RELAXED);
+  return (value & XDP_RING_NEED_WAKEUP) != 0;
+}
+
+} // namespace
+
+XdpDevice::XdpDevice(const char *device_name, int fd, int if_index)
+    : Device(device_name), fd_(fd), if_index_(if_index), queue_id_(0),
+      umem_(nullptr), umem_size_(0), fill_(), completion_(), rx_(), tx_(),
+      free_frames_(), tx_pending_(0), tx_batch_(1), program_(nullptr) {}
+
+XdpDevice::~XdpDevice() {
+  // detach the program before closing the socket
+  program_.reset();
+  __real_close(fd_);
+  for (Ring *ring : {&fill_, &completion_, &rx_, &tx_}) {
+    if (ring->map != nullptr) {
+      munmap(ring->map, ring->map_size);
+    }
+  }
+  if (umem_ != nullptr) {
+    munmap(umem_, umem_size_);
+  }
+}
+
+std::unique_ptr<XdpDevice> XdpDevice::create(const char *device_name,
+                                             const DeviceConfig &config) {
+  int if_index = static_cast<int>(if_nametoindex(device_name));
+  if (if_index == 0) {
+    LOG(ERROR) << "if_nametoindex failed " << strerror(errno) << ": "
+               << device_name;
+    return nullptr;
+  }
+  if (config.queue_id >= XdpProgram::kMaxQueues) {
+    LOG(ERROR) << "queue " << config.queue_id << " is out of range";
+    return nullptr;
+  }
+
+  int fd = __real_socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    LOG(ERROR) << "socket failed " << strerror(errno) << ": " << device_name;
+    return nullptr;
+  }
+
+  std::unique_ptr<XdpDevice> device(new XdpDevice(device_name, fd, if_index));
+  if (!device->setupUmem(config) || !device->bindSocket(config) ||
+      !device->attachProgram(config)) {
+    return nullptr;
+  }
+  return device;
+}
+
+/**
+ * @brief Register the UMEM, map the four rings, put the first half of the
+ * frames into the fill ring and keep the other half for sending.
+ * The rings have a slot for every frame, so they never overflow.
+ */
+bool XdpDevice::setupUmem(const DeviceConfig &config) {
+  uint32_t frame_count = 2;
+  while (frame_count < config.frame_count) {
+    frame_count <<= 1u;
+  }
+  umem_size_ = frame_count * kFrameSize;
+  void *umem = mmap(nullptr, umem_size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  if (umem == MAP_FAILED) {
+    LOG(ERROR) << "mmap failed " << strerror(errno);
+    return false;
+  }
+  umem_ = static_cast<char *>(umem);
+
+  xdp_umem_reg reg{};
+  reg.addr = reinterpret_cast<uint64_t>(umem_);
+  reg.len = umem_size_;
+  reg.chunk_size = kFrameSize;
+  if (setsockopt(fd_, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0) {
+    LOG(ERROR) << "XDP_UMEM_REG failed " << strerror(errno);
+    return false;
+  }
+
+  for (int option : {XDP_UMEM_FILL_RING, XDP_UMEM_COMPLETION_RING,
+                     XDP_RX_RING, XDP_TX_RING}) {
+    int rv = setsockopt(fd_, SOL_XDP, option, &frame_count,
+                        sizeof(frame_count));
+    if (rv < 0) {
+      LOG(ERROR) << "setting the size of ring " << option << " failed "
+                 << strerror(errno);
+      return false;
+    }
+  }
+
+  xdp_mmap_offsets offsets{};
+  socklen_t length = sizeof(offsets);
+  if (getsockopt(fd_, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &length) < 0) {
+    LOG(ERROR) << "XDP_MMAP_OFFSETS failed " << strerror(errno);
+    return false;
+  }
+  if (!mapRing(&fill_, offsets.fr, frame_count, sizeof(uint64_t),
+               XDP_UMEM_PGOFF_FILL_RING) ||
+      !mapRing(&completion_, offsets.cr, frame_count, sizeof(uint64_t),
+               XDP_UMEM_PGOFF_COMPLETION_RING) ||
+      !mapRing(&rx_, offsets.rx, frame_count, sizeof(xdp_desc),
+               XDP_PGOFF_RX_RING) ||
+      !mapRing(&tx_, offsets.tx, frame_count, sizeof(xdp_desc),
+               XDP_PGOFF_TX_RING)) {
+    return false;
+  }
+
+  auto *fill = reinterpret_cast<uint64_t *>(fill_.descs);
+  for (uint32_t i = 0; i < frame_count / 2; i++) {
+    fill[i] = i * kFrameSize;
+  }
+  __atomic_store_n(fill_.producer, frame_count / 2, __ATOMIC_RELEASE);
+  for (uint32_t i = frame_count / 2; i < frame_count; i++) {
+    free_frames_.push_back(i * kFrameSize);
+  }
+  return true;
+}
+
+bool XdpDevice::mapRing(Ring *ring, const xdp_ring_offset &offset,
+                        uint32_t size, size_t desc_size, off_t page_offset) {
+  ring->map_size = offset.desc + size * desc_size;
+  void *map = mmap(nullptr, ring->map_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd_, page_offset);
+  if (map == MAP_FAILED) {
+    LOG(ERROR) << "mmap ring failed " << strerror(errno);
+    ring->map = nullptr;
+    return false;
+  }
+
+  char *base = static_cast<char *>(map);
+  ring->map = map;
+  ring->producer = reinterpret_cast<uint32_t *>(base + offset.producer);
+  ring->consumer = reinterpret_cast<uint32_t *>(base + offset.consumer);
+  ring->flags = reinterpret_cast<uint32_t *>(base + offset.flags);
+  ring->descs = base + offset.desc;
+  ring->mask = size - 1;
+  return true;
+}
+
+bool XdpDevice::bindSocket(const DeviceConfig &config) {
+  queue_id_ = config.queue_id;
+  tx_batch_ = std::max<size_t>(config.tx_batch, 1);
+
+  sockaddr_xdp address{};
+  address.sxdp_family = AF_XDP;
+  address.sxdp_ifindex = if_index_;
+  address.sxdp_queue_id = queue_id_;
+  address.sxdp_flags = (config.zero_copy ? XDP_ZEROCOPY : XDP_COPY) |
+                       XDP_USE_NEED_WAKEUP;
+  if (__real_bind(fd_, reinterpret_cast<sockaddr *>(&address),
+                  sizeof(address)) < 0) {
+    LOG(ERROR) << "bind failed " << strerror(errno) << ": " << getDeviceName();
+    return false;
+  }
+  return true;
+}
+
+bool XdpDevice::attachProgram(const DeviceConfig &config) {
+  program_ = XdpProgram::create(getIpAddress().toInAddr());
+  return program_ != nullptr && program_->addSocket(queue_id_, fd_) &&
+         program_->attach(if_index_, config.zero_copy);
+}
+
+void XdpDevice::sendFrameWithHeader(const char *header, char *buf,
+                                    size_t len) {
+  if (len > kEtherDataLengthMax) {
+    LOG(ERROR) << "frame is too long: " << len;
+    return;
+  }
+
+  if (free_frames_.empty()) {
+    reclaim();
+  }
+  if (free_frames_.empty()) {
+    LOG(ERROR) << "no free UMEM frame, drop a frame: " << getDeviceName();
+    return;
+  }
+  uint64_t address = free_frames_.back();
+  free_frames_.pop_back();
+
+  char *frame = umem_ + address;
+  memcpy(frame, header, kEtherHeaderLength);
+  memcpy(frame + kEtherHeaderLength, buf, len);
+  if (len < kEtherDataLengthMin) {
+    memset(frame + kEtherHeaderLength + len, 0, kEtherDataLengthMin - len);
+    len = kEtherDataLengthMin;
+  }
+
+  // |tx_| has a slot for every frame, so it is never full here
+  uint32_t producer = *tx_.producer;
+  auto *desc = reinterpret_cast<xdp_desc *>(tx_.descs) + (producer & tx_.mask);
+  desc->addr = address;
+  desc->len = kEtherHeaderLength + len;
+  desc->options = 0;
+  __atomic_store_n(tx_.producer, producer + 1, __ATOMIC_RELEASE);
+
+  if (++tx_pending_ >= tx_batch_) {
+    flush();
+  }
+}
+
+/**
+ * @brief Kick the kernel once for all frames put on |tx_| since the last
+ * flush. The copy mode sends a limited batch per syscall and fails with
+ * EAGAIN while frames are left on the ring.
+ */
+void XdpDevice::flush() {
+  if (tx_pending_ == 0) {
+    return;
+  }
+  tx_pending_ = 0;
+
+  for (uint32_t i = 0; i <= tx_.mask && needsWakeup(tx_.flags); i++) {
+    if (sendto(fd_, nullptr, 0, MSG_DONTWAIT, nullptr, 0) >= 0) {
+      break;
+    }
+    if (errno != EAGAIN) {
+      if (errno != EBUSY && errno != ENOBUFS) {
+        LOG(ERROR) << "sendto failed " << strerror(errno);
+      }
+      break;
+    }
+  }
+}
+
+void XdpDevice::reclaim() {
+  uint32_t consumer = *completion_.consumer;
+  uint32_t producer = __atomic_load_n(completion_.producer, __ATOMIC_ACQUIRE);
+  auto *addresses = reinterpret_cast<uint64_t *>(completion_.descs);
+  for (; consumer != producer; consumer++) {
+    free_frames_.push_back(addresses[consumer & completion_.mask]);
+  }
+  __atomic_store_n(completion_.consumer, consumer, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Hand the received frames to the callback in place, then give them
+ * back to the kernel through the fill ring.
+ */
+void XdpDevice::onReadable() {
+  uint32_t consumer = *rx_.consumer;
+  uint32_t producer = __atomic_load_n(rx_.producer, __ATOMIC_ACQUIRE);
+  if (consumer == producer) {
+    return;
+  }
+
+  auto *descs = reinterpret_cast<xdp_desc *>(rx_.descs);
+  auto *fill = reinterpret_cast<uint64_t *>(fill_.descs);
+  uint32_t fill_producer = *fill_.producer;
+  for (; consumer != producer; consumer++) {
+    const xdp_desc &desc = descs[consumer & rx_.mask];
+    decodeFrame(umem_ + desc.addr, desc.len);
+    // the address may point into the frame, return the whole frame
+    fill[fill_producer & fill_.mask] = desc.addr - desc.addr % kFrameSize;
+    fill_producer++;
+  }
+  __atomic_store_n(rx_.consumer, consumer, __ATOMIC_RELEASE);
+  __atomic_store_n(fill_.producer, fill_producer, __ATOMIC_RELEASE);
+
+  if (needsWakeup(fill_.flags)) {
+    recvfrom(fd_, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+  }
+}
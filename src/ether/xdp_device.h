@@ -0,0 +1,89 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_ETHER_XDP_DEVICE_H
+#define SRC_ETHER_XDP_DEVICE_H
+
+#include "device.h"
+#include "xdp_program.h"
+#include <linux/if_xdp.h>
+#include <vector>
+
+/**
+ * @brief A device on an AF_XDP socket.
+ * An XDP program attached to the interface redirects the IPv4 frames to the
+ * device address into the socket, everything else goes on to the kernel.
+ * Frames live in the UMEM shared with the kernel, |onReadable| hands them to
+ * the callback in place and gives them back through the fill ring.
+ * Sending copies a frame into a free UMEM frame, the kernel is kicked once
+ * per |DeviceConfig::tx_batch| frames or flush if it asks for a wakeup.
+ */
+class XdpDevice : public Device {
+public:
+  DISALLOW_COPY_AND_ASSIGN(XdpDevice)
+  ~XdpDevice() override;
+
+  /**
+   * @brief Set up the UMEM and the rings, then load and attach the program.
+   * @return nullptr on failure, e.g. without CAP_NET_ADMIN and CAP_BPF
+   */
+  static std::unique_ptr<XdpDevice> create(const char *device_name,
+                                           const DeviceConfig &config);
+
+  using Device::sendFrame;
+  void sendFrame(char *buf, size_t len, MacAddress dst) override {
+    encodeAndSend(buf, len, dst);
+  }
+  void sendFrameWithHeader(const char *header, char *buf,
+                           size_t len) override;
+
+  void onReadable() override;
+
+  int getFd() override { return fd_; }
+
+  void flush() override;
+
+private:
+  XdpDevice(const char *device_name, int fd, int if_index);
+
+  // A single-producer single-consumer ring shared with the kernel.
+  struct Ring {
+    uint32_t *producer = nullptr;
+    uint32_t *consumer = nullptr;
+    uint32_t *flags = nullptr;
+    char *descs = nullptr;
+    uint32_t mask = 0;
+    void *map = nullptr;
+    size_t map_size = 0;
+  };
+
+  bool setupUmem(const DeviceConfig &config);
+  bool mapRing(Ring *ring, const xdp_ring_offset &offset, uint32_t size,
+               size_t desc_size, off_t page_offset);
+  bool bindSocket(const DeviceConfig &config);
+  bool attachProgram(const DeviceConfig &config);
+
+  // Move the frames sent by the kernel back to |free_frames_|.
+  void reclaim();
+
+  int fd_;
+  int if_index_;
+  uint32_t queue_id_;
+
+  char *umem_;
+  size_t umem_size_;
+  Ring fill_;
+  Ring completion_;
+  Ring rx_;
+  Ring tx_;
+  // UMEM addresses of the frames available for sending
+  std::vector<uint64_t> free_frames_;
+  // frames put on |tx_| since the last kick
+  size_t tx_pending_;
+  size_t tx_batch_;
+
+  std::unique_ptr<XdpProgram> program_;
+};
+
+#endif // SRC_ETHER_XDP_DEVICE_H
@@ -0,0 +1,202 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "xdp_program.h"
+#include "../ip/ipv4_header.h"
+#include "../posix/wrap_function.h"
+#include "./arp_header.h"
+#include "./ethernet_header.h"
+#include "./type.h"
+#include <cerrno>
+#include <cstring>
+#include <glog/logging.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+int bpf(int cmd, bpf_attr *attr) {
+  return static_cast<int>(syscall(__NR_bpf, cmd, attr, sizeof(*attr)));
+}
+
+bpf_insn instruction(uint8_t code, uint8_t dst, uint8_t src, int16_t offset,
+                     int32_t imm) {
+  bpf_insn rv{};
+  rv.code = code;
+  rv.dst_reg = dst;
+  rv.src_reg = src;
+  rv.off = offset;
+  rv.imm = imm;
+  return rv;
+}
+
+/**
+ * @brief The XDP program redirecting the IPv4 frames to |address|, and the
+ * ARP packets asking for or answering to it, into the socket of their
+ * receive queue in |map_fd|. Other frames, and frames of a queue without a
+ * socket, are passed to the kernel.
+ */
+std::vector<bpf_insn> buildProgram(int map_fd, in_addr address) {
+  const int16_t kData = offsetof(xdp_md, data);
+  const int16_t kDataEnd = offsetof(xdp_md, data_end);
+  const int16_t kQueue = offsetof(xdp_md, rx_queue_index);
+  const int16_t kType = EthernetHeader::Type::kOffset;
+  const int16_t kDestination =
+      kEtherHeaderLength + IPv4Header::Destination::kOffset;
+  const int32_t kHeaders = kEtherHeaderLength + IPv4Header::kLength;
+  const int16_t kTarget = kEtherHeaderLength + ArpHeader::TargetIp::kOffset;
+  const int32_t kArpHeaders = kEtherHeaderLength + ArpHeader::kLength;
+  const auto kAddress = static_cast<int32_t>(address.s_addr);
+
+  std::vector<bpf_insn> program = {
+      // r6 = ctx, r2 = data, r3 = data_end
+      instruction(BPF_ALU64 | BPF_MOV | BPF_X, 6, 1, 0, 0),
+      instruction(BPF_LDX | BPF_MEM | BPF_W, 2, 1, kData, 0),
+      instruction(BPF_LDX | BPF_MEM | BPF_W, 3, 1, kDataEnd, 0),
+      instruction(BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0),
+      instruction(BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, kEtherHeaderLength),
+      instruction(BPF_JMP | BPF_JGT | BPF_X, 4, 3, 0, 0),
+      // the fields are compared in network byte order
+      instruction(BPF_LDX | BPF_MEM | BPF_H, 5, 2, kType, 0),
+      instruction(BPF_JMP | BPF_JEQ | BPF_K, 5, 0, 0, htons(kEtherTypeARP)),
+      instruction(BPF_JMP | BPF_JNE | BPF_K, 5, 0, 0, htons(kEtherTypeIPv4)),
+      // both headers must be in the frame
+      instruction(BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0),
+      instruction(BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, kHeaders),
+      instruction(BPF_JMP | BPF_JGT | BPF_X, 4, 3, 0, 0),
+      instruction(BPF_LDX | BPF_MEM | BPF_W, 5, 2, kDestination, 0),
+      instruction(BPF_JMP32 | BPF_JNE | BPF_K, 5, 0, 0, kAddress),
+      instruction(BPF_JMP | BPF_JA, 0, 0, 0, 0),
+  };
+
+  // an ARP packet whose target is |address|
+  auto arp = static_cast<int16_t>(program.size());
+  program.insert(
+      program.end(),
+      {
+          instruction(BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0),
+          instruction(BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, kArpHeaders),
+          instruction(BPF_JMP | BPF_JGT | BPF_X, 4, 3, 0, 0),
+          instruction(BPF_LDX | BPF_MEM | BPF_W, 5, 2, kTarget, 0),
+          instruction(BPF_JMP32 | BPF_JNE | BPF_K, 5, 0, 0, kAddress),
+      });
+
+  // return bpf_redirect_map(map, ctx->rx_queue_index, XDP_PASS)
+  auto redirect = static_cast<int16_t>(program.size());
+  program.insert(
+      program.end(),
+      {
+          instruction(BPF_LDX | BPF_MEM | BPF_W, 2, 6, kQueue, 0),
+          instruction(BPF_LD | BPF_DW | BPF_IMM, 1, BPF_PSEUDO_MAP_FD, 0,
+                      map_fd),
+          instruction(0, 0, 0, 0, 0),
+          instruction(BPF_ALU64 | BPF_MOV | BPF_K, 3, 0, 0, XDP_PASS),
+          instruction(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+          instruction(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+      });
+
+  // failed checks go to the pass label below, the other jumps to the labels
+  // above
+  auto pass = static_cast<int16_t>(program.size());
+  for (int16_t i = 0; i < pass; i++) {
+    uint8_t code = program[i].code;
+    if (BPF_CLASS(code) != BPF_JMP && BPF_CLASS(code) != BPF_JMP32) {
+      continue;
+    }
+    int16_t target = 0;
+    switch (BPF_OP(code)) {
+    case BPF_JGT:
+    case BPF_JNE:
+      target = pass;
+      break;
+    case BPF_JEQ:
+      target = arp;
+      break;
+    case BPF_JA:
+      target = redirect;
+      break;
+    default:
+      continue;
+    }
+    program[i].off = static_cast<int16_t>(target - i - 1);
+  }
+  program.push_back(
+      instruction(BPF_ALU64 | BPF_MOV | BPF_K, 0, 0, 0, XDP_PASS));
+  program.push_back(instruction(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+  return program;
+}
+
+} // namespace
+
+XdpProgram::XdpProgram() : map_fd_(-1), program_fd_(-1), link_fd_(-1) {}
+
+XdpProgram::~XdpProgram() {
+  // closing the link detaches the program
+  for (int fd : {link_fd_, program_fd_, map_fd_}) {
+    if (fd >= 0) {
+      __real_close(fd);
+    }
+  }
+}
+
+std::unique_ptr<XdpProgram> XdpProgram::create(in_addr address) {
+  std::unique_ptr<XdpProgram> rv(new XdpProgram());
+
+  bpf_attr attr{};
+  attr.map_type = BPF_MAP_TYPE_XSKMAP;
+  attr.key_size = sizeof(uint32_t);
+  attr.value_size = sizeof(int);
+  attr.max_entries = kMaxQueues;
+  if ((rv->map_fd_ = bpf(BPF_MAP_CREATE, &attr)) < 0) {
+    LOG(ERROR) << "creating the XSKMAP failed " << strerror(errno);
+    return nullptr;
+  }
+
+  std::vector<bpf_insn> program = buildProgram(rv->map_fd_, address);
+  static char license[] = "GPL";
+  char log[4096] = {};
+  memset(&attr, 0, sizeof(attr));
+  attr.prog_type = BPF_PROG_TYPE_XDP;
+  attr.insn_cnt = program.size();
+  attr.insns = reinterpret_cast<uint64_t>(program.data());
+  attr.license = reinterpret_cast<uint64_t>(license);
+  attr.log_level = 1;
+  attr.log_buf = reinterpret_cast<uint64_t>(log);
+  attr.log_size = sizeof(log);
+  if ((rv->program_fd_ = bpf(BPF_PROG_LOAD, &attr)) < 0) {
+    LOG(ERROR) << "loading the XDP program failed " << strerror(errno) << "\n"
+               << log;
+    return nullptr;
+  }
+  return rv;
+}
+
+bool XdpProgram::addSocket(uint32_t queue_id, int fd) {
+  bpf_attr attr{};
+  attr.map_fd = map_fd_;
+  attr.key = reinterpret_cast<uint64_t>(&queue_id);
+  attr.value = reinterpret_cast<uint64_t>(&fd);
+  if (bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+    LOG(ERROR) << "updating the XSKMAP failed " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+bool XdpProgram::attach(int if_index, bool driver_mode) {
+  bpf_attr attr{};
+  attr.link_create.prog_fd = program_fd_;
+  attr.link_create.target_ifindex = if_index;
+  attr.link_create.attach_type = BPF_XDP;
+  attr.link_create.flags =
+      driver_mode ? XDP_FLAGS_DRV_MODE : XDP_FLAGS_SKB_MODE;
+  if ((link_fd_ = bpf(BPF_LINK_CREATE, &attr)) < 0) {
+    LOG(ERROR) << "attaching the XDP program failed " << strerror(errno);
+    return false;
+  }
+  return true;
+}
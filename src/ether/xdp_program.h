@@ -0,0 +1,47 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_ETHER_XDP_PROGRAM_H
+#define SRC_ETHER_XDP_PROGRAM_H
+
+#include "../base/util.h"
+#include <netinet/in.h>
+
+/**
+ * @brief The XDP program of an XdpDevice with its XSKMAP.
+ * It redirects the IPv4 frames and the ARP packets to one address into the
+ * AF_XDP socket of their receive queue and passes every other frame to the
+ * kernel. The program is detached when this object is destroyed.
+ *
+ * Note that linux/bpf.h and pcap both define `struct bpf_insn`, so this
+ * header exposes none of them.
+ */
+class XdpProgram {
+public:
+  DISALLOW_COPY_AND_ASSIGN(XdpProgram)
+  ~XdpProgram();
+
+  // Create the map and load the program, nullptr on failure.
+  static std::unique_ptr<XdpProgram> create(in_addr address);
+
+  // Redirect the frames of |queue_id| to the AF_XDP socket |fd|.
+  bool addSocket(uint32_t queue_id, int fd);
+
+  /**
+   * @brief Link the program to the interface. The generic mode works with
+   * every driver, the driver mode is needed for zero copy.
+   */
+  bool attach(int if_index, bool driver_mode);
+
+  static const uint32_t kMaxQueues = 64;
+
+private:
+  XdpProgram();
+
+  int map_fd_;
+  int program_fd_;
+  int link_fd_;
+};
+
+#endif // SRC_ETHER_XDP_PROGRAM_H
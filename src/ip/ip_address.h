@@ -39,6 +39,9 @@ public:
 
   bool writeTo(DataWriter *writer);
 
+  // The IPv4 address in network byte order.
+  inline in_addr toInAddr() const { return address_.v4; }
+
   std::string toString() const;
 
   // to use IP address as key of hash maps
@@ -50,6 +53,10 @@ public:
 
   bool isInaddrAny() const;
 
+  inline bool isSpecified() const {
+    return family_ != IPAddressFamily::IP_UNSPEC;
+  }
+
 private:
   union {
     in_addr v4;
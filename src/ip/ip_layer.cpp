@@ -6,7 +6,9 @@
 #include "ip_layer.h"
 
 #include "../base/checksum.h"
+#include "../base/layer_profile.h"
 #include "../base/util.h"
+#include "ipv4_header.h"
 
 /**
  *
@@ -69,9 +71,7 @@ IPLayer::IPLayer(DeviceManager *device_manager, AlarmFactory *alarm_factory)
     : device_manager_(device_manager), routing_table_(alarm_factory),
       buffer_(new char[kMaxIpPacketLength]), callback_(nullptr),
       alarm_factory_(alarm_factory),
-      probe_alarm_(alarm_factory->createAlarm(
-          std::make_unique<ProbeAlarmDelegate>(this))),
-      rand_generator_(233) {
+      probe_alarm_(alarm_factory, this), rand_generator_(233) {
 
   // add self IPs to routing talbe so that they appear in DVs
   // these entries will never be updated or marked as invalid
@@ -82,7 +82,7 @@ IPLayer::IPLayer(DeviceManager *device_manager, AlarmFactory *alarm_factory)
   }
   DLOG(INFO) << "initial table";
   routing_table_.printTable();
-  probe_alarm_->set(alarm_factory->now() + probeInterval());
+  probe_alarm_.set(alarm_factory->now() + probeInterval());
 }
 
 /**
@@ -96,28 +96,29 @@ IPLayer::IPLayer(DeviceManager *device_manager, AlarmFactory *alarm_factory)
  * @param len
  */
 void IPLayer::onReceive(Device *device, char *buf, size_t len) {
-  DCHECK(len >= kPacketHeaderLength);
-
+  LayerProfile::Scope scope(LayerProfile::NETWORK);
   DataReader reader(buf, len);
-  uint8_t rv;
-  reader.readUInt8(&rv);
+  const char *header = reader.readHeader<IPv4Header>();
+  if (header == nullptr) {
+    LOG(INFO) << "truncated IP packet";
+    return;
+  }
+  uint8_t rv = IPv4Header::VersionAndLength::load(header);
   if ((rv >> 4u) != 0x4) { // version 4
     LOG(INFO) << "unsupported IP version " << (rv >> 4u);
     return;
   }
 
   size_t header_length = (rv & 0xfu) * 4;
+  if (header_length < kPacketHeaderLength || header_length > len) {
+    LOG(INFO) << "bad IP header length " << header_length;
+    return;
+  }
 
-  reader.skip(1); // type of service
-  uint16_t total_length;
-  DCHECK(reader.readUInt16(&total_length));
-  reader.skip(5);
-  ServiceProtocol protocol;
-  reader.readUInt8(&rv);
-  protocol = (ServiceProtocol)rv;
-  reader.skip(2); // checksum
-  IPAddress source(&reader);
-  IPAddress destination(&reader);
+  uint16_t total_length = IPv4Header::TotalLength::load(header);
+  auto protocol = (ServiceProtocol)IPv4Header::Protocol::load(header);
+  IPAddress source(IPv4Header::Source::load(header));
+  IPAddress destination(IPv4Header::Destination::load(header));
 
   // skip options
 
@@ -170,12 +171,20 @@ void IPLayer::processProbePacket(const IPAddress &src, const IPAddress &dest,
   routing_table_.updateTable(buf, len, device);
 }
 
+/**
+ * @brief Decrement the TTL and patch the header checksum incrementally.
+ *
+ * @return false if the TTL is already 0
+ */
 bool IPLayer::subtractTTL(char *buf, size_t len) {
   auto *ptr = (uint8_t *)(buf + kTTLHeaderOffset);
   if (*ptr == 0) {
     return false;
   }
+  // TTL is the high byte of the word shared with the protocol
+  uint16_t old_word = (ptr[0] << 8u) | ptr[1];
   *ptr -= 1;
+  Checksum::replace16(buf + kChecksumHeaderOffset, old_word, old_word - 0x100);
   return true;
 }
 
@@ -192,7 +201,7 @@ void IPLayer::sendProbePacket() {
 
   DLOG(INFO) << "sending routing table";
 
-  probe_alarm_->update(alarm_factory_->now() + probeInterval());
+  probe_alarm_.update(alarm_factory_->now() + probeInterval());
   return;
 }
 
@@ -225,4 +234,6 @@ IPAddress IPLayer::getDefaultIP() {
   return device_manager_->findDefaultDevice()->getIpAddress();
 }
 
-IPLayer::IPLayer() : rand_generator_(0), routing_table_(nullptr) {}
+IPLayer::IPLayer()
+    : rand_generator_(0), routing_table_(nullptr),
+      probe_alarm_(nullptr, this) {}
@@ -77,14 +77,12 @@ private:
 
   void sendProbePacket();
 
-  DEFINE_ALARM_DELEGATE(ProbeAlarmDelegate, IPLayer, sendProbePacket);
-
   DeviceManager *device_manager_;
   RoutingTable routing_table_;
   std::unique_ptr<char[]> buffer_;
   IPacketCallback *callback_;
   AlarmFactory *alarm_factory_;
-  Alarm *probe_alarm_;
+  MemberAlarm<IPLayer, &IPLayer::sendProbePacket> probe_alarm_;
   RandGenerator rand_generator_;
 };
 
@@ -0,0 +1,34 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_IP_IPV4_HEADER_H
+#define SRC_IP_IPV4_HEADER_H
+
+#include "../base/header_layout.h"
+#include "./type.h"
+#include <netinet/in.h>
+
+/**
+ * @brief Field layout of the IPv4 header without options.
+ */
+struct IPv4Header {
+  static constexpr size_t kLength = kPacketHeaderLength;
+
+  typedef HeaderField<uint8_t, 0> VersionAndLength;
+  typedef HeaderField<uint8_t, 1> TypeOfService;
+  typedef HeaderField<uint16_t, 2> TotalLength;
+  typedef HeaderField<uint16_t, 4> Identification;
+  typedef HeaderField<uint16_t, 6> FlagsAndFragment;
+  typedef HeaderField<uint8_t, 8> TimeToLive;
+  typedef HeaderField<uint8_t, 9> Protocol;
+  typedef HeaderField<uint16_t, 10> Checksum;
+  typedef RawHeaderField<in_addr, 12> Source;
+  typedef RawHeaderField<in_addr, 16> Destination;
+
+  static_assert(Destination::kEnd == kLength, "IPv4 header layout");
+  static_assert(TimeToLive::kOffset == kTTLHeaderOffset, "TTL offset");
+  static_assert(Checksum::kOffset == kChecksumHeaderOffset, "checksum offset");
+};
+
+#endif // SRC_IP_IPV4_HEADER_H
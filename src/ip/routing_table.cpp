@@ -130,13 +130,10 @@ void RoutingTable::Clear() { entries_.clear(); }
 RoutingTable::Entry::Entry(IPAddress dst, IPAddress msk, Device *dev,
                            uint8_t mtrc, AlarmFactory *table_alarm_fac)
     : dest(dst), mask(msk), device(dev), metric(mtrc),
-      table_alarm_factory_(table_alarm_fac) {
+      table_alarm_factory_(table_alarm_fac),
+      ttl_alarm_(table_alarm_fac, this) {
   if (table_alarm_factory_) {
-    ttl_alarm_ = table_alarm_factory_->createAlarm(
-        std::make_unique<EntryTimeoutAlarmDelegate>(this));
-    ttl_alarm_->set(table_alarm_factory_->now() + validInterval());
-  } else {
-    ttl_alarm_ = nullptr;
+    ttl_alarm_.set(table_alarm_factory_->now() + validInterval());
   }
 }
 
@@ -153,9 +150,9 @@ void RoutingTable::Entry::revokeRoute() {
  * @brief Keep an entry valid for at least `validInterval'
  */
 void RoutingTable::Entry::keepAlive() {
-  if (ttl_alarm_) {
-    ttl_alarm_->update(table_alarm_factory_->now() + validInterval(),
-                       TimeBase::Delta::fromSeconds(1));
+  if (table_alarm_factory_) {
+    ttl_alarm_.update(table_alarm_factory_->now() + validInterval(),
+                      TimeBase::Delta::fromSeconds(1));
   }
 }
 
@@ -10,6 +10,7 @@
 
 #include "../base/alarm.h"
 #include "../base/alarm_factory.h"
+#include "../base/embedded_alarm.h"
 #include "../base/util.h"
 #include "../ether/device_manager.h"
 #include "../ether/mac_address.h"
@@ -45,9 +46,9 @@ public:
 
   private:
     AlarmFactory *table_alarm_factory_;
-    Alarm *ttl_alarm_;
     void revokeRoute();
-    DEFINE_ALARM_DELEGATE(EntryTimeoutAlarmDelegate, Entry, revokeRoute);
+    // only set if |table_alarm_factory_| is not nullptr
+    MemberAlarm<Entry, &Entry::revokeRoute> ttl_alarm_;
     static constexpr TimeBase::Delta validInterval() {
       // Set valid interval to be 2 times of probeInterval
       return TimeBase::Delta::fromSeconds(6);
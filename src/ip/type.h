@@ -12,5 +12,6 @@ const size_t kMaxIpPacketLength = 1500;
 const size_t kPacketHeaderLength = 20;
 const uint8_t kDefaultTTL = 64;
 const size_t kTTLHeaderOffset = 8;
+const size_t kChecksumHeaderOffset = 10;
 
 #endif // SRC_IP_TYPE_H
@@ -0,0 +1,60 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "capture_filter.h"
+#include "../ip/ip_layer.h"
+#include <algorithm>
+#include <glog/logging.h>
+#include <sstream>
+#include <vector>
+
+CaptureFilter::CaptureFilter(DeviceManager *device_manager)
+    : device_manager_(device_manager) {}
+
+void CaptureFilter::install() {
+  DeviceManager::IpSet hosts = device_manager_->getAllDevicesIpAddress();
+  for (Device *device : device_manager_->getAllDevices()) {
+    std::string filter = expression(device->getMacAddress(), hosts);
+    if (!device->setFilter(filter)) {
+      LOG(ERROR) << "cannot filter " << device->getDeviceName()
+                 << ", it receives all frames";
+      continue;
+    }
+    DLOG(INFO) << device->getDeviceName() << " filter: " << filter;
+  }
+}
+
+/**
+ * @brief The operators of pcap filters have the same precedence, so every
+ * term is parenthesized.
+ */
+std::string CaptureFilter::expression(MacAddress mac_address,
+                                      const DeviceManager::IpSet &hosts) {
+  std::vector<std::string> names;
+  for (IPAddress address : hosts) {
+    names.push_back(address.toString());
+  }
+  std::sort(names.begin(), names.end());
+
+  std::ostringstream os;
+  os << "arp or ip proto " << static_cast<int>(ServiceProtocol::TESTING0)
+     << " or ip proto " << static_cast<int>(ServiceProtocol::TESTING1);
+
+  os << " or (ether dst " << mac_address.toString() << " and ip";
+  for (const std::string &name : names) {
+    os << " and not dst host " << name;
+  }
+  os << ")";
+
+  if (names.empty()) {
+    return os.str();
+  }
+
+  os << " or (tcp and (";
+  for (size_t i = 0; i < names.size(); i++) {
+    os << (i == 0 ? "" : " or ") << "dst host " << names[i];
+  }
+  os << "))";
+  return os.str();
+}
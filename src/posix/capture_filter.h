@@ -0,0 +1,44 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_POSIX_CAPTURE_FILTER_H
+#define SRC_POSIX_CAPTURE_FILTER_H
+
+#include "../base/util.h"
+#include "../ether/device_manager.h"
+#include <string>
+
+/**
+ * @brief The kernel filter of all devices, generated from the IP addresses
+ * of our devices.
+ * A device lets in ARP, routing probes, packets to be forwarded, i.e. sent
+ * to its MAC address but not to our IP addresses, and TCP segments to our
+ * IP addresses. Everything else the interface sees, like the traffic of
+ * other hosts on a shared link, never wakes the event loop.
+ *
+ * The TCP segments are not narrowed to the ports of our sockets: a segment
+ * of an unknown connection, e.g. a stale ACK after a restart, must reach
+ * the ResetDispatcher to be answered with a reset, as RFC 793 says.
+ */
+class CaptureFilter {
+public:
+  DISALLOW_COPY_AND_ASSIGN(CaptureFilter)
+
+  explicit CaptureFilter(DeviceManager *device_manager);
+
+  // Install the filter of every device.
+  void install();
+
+  /**
+   * @brief The pcap filter expression of a device with |mac_address| on a
+   * host with the IP addresses |hosts|.
+   */
+  static std::string expression(MacAddress mac_address,
+                                const DeviceManager::IpSet &hosts);
+
+private:
+  DeviceManager *device_manager_;
+};
+
+#endif // SRC_POSIX_CAPTURE_FILTER_H
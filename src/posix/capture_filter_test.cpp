@@ -0,0 +1,31 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "capture_filter.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const MacAddress kMacAddress("02:00:00:00:00:01");
+
+} // namespace
+
+TEST(CaptureFilterTest, NoHost) {
+  std::string filter =
+      CaptureFilter::expression(kMacAddress, DeviceManager::IpSet());
+  EXPECT_EQ(filter.find("tcp"), std::string::npos);
+  // ether_ntoa drops the leading zeros
+  EXPECT_NE(filter.find("(ether dst 2:0:0:0:0:1 and ip)"), std::string::npos);
+}
+
+TEST(CaptureFilterTest, AllSegmentsToUs) {
+  DeviceManager::IpSet hosts{IPAddress("10.0.0.2"), IPAddress("10.0.0.1")};
+  std::string filter = CaptureFilter::expression(kMacAddress, hosts);
+  EXPECT_NE(filter.find("and not dst host 10.0.0.1 and not dst host 10.0.0.2"),
+            std::string::npos);
+  // any segment to us reaches a dispatcher, a stale ACK to a closed port
+  // is answered with a reset
+  std::string tcp = filter.substr(filter.find(" or (tcp "));
+  EXPECT_EQ(tcp, " or (tcp and (dst host 10.0.0.1 or dst host 10.0.0.2))");
+}
@@ -15,6 +15,10 @@ void ListenDispatcher::onReceivePacket(char *buffer, size_t length,
                                        IPAddress destination) {
   std::unique_ptr<Segment> segment =
       Segment::parse(source, destination, buffer, length);
+  if (segment == nullptr) {
+    DLOG(ERROR) << "drop a malformed segment";
+    return;
+  }
   SocketAddress to = segment->destination_;
   SocketAddress from = segment->source_;
 
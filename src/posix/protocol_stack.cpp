@@ -7,7 +7,6 @@
 #include "wrap_function.h"
 #include <fcntl.h>
 #include <string.h>
-#include <thread>
 #include <zconf.h>
 
 #define RETURN_ERRNO(err)                                                      \
@@ -17,16 +16,19 @@
   } while (false)
 
 ProtocolStack::ProtocolStack()
-    : epoll_server_(std::make_unique<EpollServer>()),
-      device_manager_(std::make_unique<DeviceManager>(epoll_server_.get())),
-      alarm_factory_(std::make_unique<EpollAlarmFactory>(epoll_server_.get())),
+    : event_loops_(std::make_unique<EpollServerGroup>(kEventLoops)),
+      epoll_server_(event_loops_->getServer(0)),
+      device_manager_(std::make_unique<DeviceManager>(
+          epoll_server_, DeviceManager::ConfigMap(), event_loops_.get())),
+      capture_filter_(std::make_unique<CaptureFilter>(device_manager_.get())),
+      alarm_factory_(event_loops_->getAlarmFactory(0)),
       ip_layer_(std::make_unique<IPLayer>(device_manager_.get(),
-                                          alarm_factory_.get())),
+                                          alarm_factory_)),
       rand_generator_(19260817), // MAGIC NUMBER
-      reset_dispatcher_(std::make_unique<ResetDispatcher>(
-          ip_layer_.get(), alarm_factory_.get())),
+      reset_dispatcher_(
+          std::make_unique<ResetDispatcher>(ip_layer_.get(), alarm_factory_)),
       listen_dispatcher_(std::make_unique<ListenDispatcher>(
-          reset_dispatcher_.get(), ip_layer_.get(), alarm_factory_.get(),
+          reset_dispatcher_.get(), ip_layer_.get(), alarm_factory_,
           &rand_generator_)),
       dispatcher_(
           std::make_unique<SegmentDispatcher>(listen_dispatcher_.get())),
@@ -37,11 +39,14 @@ ProtocolStack::ProtocolStack()
   device_manager_->setCallback(ip_layer_.get());
   ip_layer_->setCallback(this);
   listen_dispatcher_->setDispatcher(dispatcher_.get());
+  epoll_server_->addIterationHook([this] { closeLingering(); });
+  // the addresses of the devices are known once they are opened
+  capture_filter_->install();
 }
 
 /**
- * @brief Create a ProtocolStack instance and spawn a thread at first call.
- * Return the instance otherwise.
+ * @brief Create a ProtocolStack instance and start its reactor threads at
+ * first call. Return the instance otherwise.
  *
  * @return ProtocolStack&
  */
@@ -53,26 +58,13 @@ ProtocolStack &ProtocolStack::getInstance() {
     std::lock_guard<std::mutex> guard(mtx);
     if (instance == nullptr) {
       ProtocolStack *rv = new ProtocolStack();
-      std::thread(ProtocolStack::startEventLoop, rv->epoll_server_.get())
-          .detach();
+      rv->event_loops_->start();
       instance = rv;
     }
   }
   return *instance;
 }
 
-/**
- * @brief EpollServer is initiated here and all events are handled through its
- * callback chains
- *
- * @param epoll_server
- */
-void ProtocolStack::startEventLoop(EpollServer *epoll_server) {
-  while (1) {
-    epoll_server->runEventLoop(TimeBase::Delta::fromMilliseconds(1000));
-  }
-}
-
 int ProtocolStack::_socket(int domain, int type, int protocol) {
   if ((domain != AF_INET) || (type != SOCK_STREAM) ||
       (protocol != 0 && protocol != IPPROTO_TCP)) {
@@ -81,11 +73,14 @@ int ProtocolStack::_socket(int domain, int type, int protocol) {
 
   int fd = dup(null_fd_);
   DCHECK(!ownFD(fd));
-  SocketAddress socket_address(ip_layer_->getDefaultIP(),
-                               // IANA: dynamic and private ports
-                               rand_generator_.rand(49162, 65536));
-
-  fd_set_[fd] = std::make_unique<SocketStruct>(socket_address);
+  epoll_server_->runInLoopAndWait([this, fd] {
+    std::lock_guard<std::mutex> guard(mutex_);
+    SocketAddress socket_address(ip_layer_->getDefaultIP(),
+                                 // IANA: dynamic and private ports
+                                 rand_generator_.rand(49162, 65536));
+
+    fd_set_[fd] = std::make_unique<SocketStruct>(socket_address);
+  });
   return fd;
 }
 
@@ -134,18 +129,23 @@ int ProtocolStack::_listen(int socket, int backlog) {
     backlog = 1;
   }
 
-  std::lock_guard<std::mutex> guard(mutex_);
-  SocketStruct *st = lookupStruct(socket);
-  if (st->type != SocketStruct::Type::UNSPECIFIED) {
-    // The socket is already connected.
-    RETURN_ERRNO(EINVAL);
-  }
-
-  st->type = SocketStruct::Type::PASSIVE;
-  st->backlog = backlog;
+  SocketStruct *st;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    st = lookupStruct(socket);
+    if (st->type != SocketStruct::Type::UNSPECIFIED) {
+      // The socket is already connected.
+      RETURN_ERRNO(EINVAL);
+    }
 
-  listen_dispatcher_->addListener(st->bind_address, st);
+    st->type = SocketStruct::Type::PASSIVE;
+    st->backlog = backlog;
+  }
 
+  epoll_server_->runInLoopAndWait([this, st] {
+    std::lock_guard<std::mutex> guard(mutex_);
+    listen_dispatcher_->addListener(st->bind_address, st);
+  });
   return 0;
 }
 
@@ -155,27 +155,33 @@ int ProtocolStack::_connect(int socket, const struct sockaddr *address,
     return __real_connect(socket, address, address_len);
   }
 
-  std::lock_guard<std::mutex> guard(mutex_);
-  SocketStruct *st = lookupStruct(socket);
+  SocketStruct *st;
   SocketAddress peer_address(address, address_len);
-  if (st->type == SocketStruct::Type::PASSIVE) {
-    // The socket is listening and cannot be connected.
-    RETURN_ERRNO(EOPNOTSUPP);
-  }
-  if (st->type == SocketStruct::Type::ACTIVE) {
-    // The specified socket is connection-mode and is already connected.
-    RETURN_ERRNO(EISCONN);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    st = lookupStruct(socket);
+    if (st->type == SocketStruct::Type::PASSIVE) {
+      // The socket is listening and cannot be connected.
+      RETURN_ERRNO(EOPNOTSUPP);
+    }
+    if (st->type == SocketStruct::Type::ACTIVE) {
+      // The specified socket is connection-mode and is already connected.
+      RETURN_ERRNO(EISCONN);
+    }
+    DCHECK(st->type == SocketStruct::Type::UNSPECIFIED);
+    st->type = SocketStruct::Type::ACTIVE;
   }
-  DCHECK(st->type == SocketStruct::Type::UNSPECIFIED);
-  st->type = SocketStruct::Type::ACTIVE;
 
-  st->session = std::move(std::make_unique<SocketSession>(
-      ip_layer_.get(), alarm_factory_.get(), st->bind_address, peer_address,
-      &rand_generator_));
-  dispatcher_->addSession(st->bind_address, peer_address, st->session.get());
+  epoll_server_->runInLoopAndWait([this, st, &peer_address] {
+    std::lock_guard<std::mutex> guard(mutex_);
+    st->session = std::move(std::make_unique<SocketSession>(
+        ip_layer_.get(), alarm_factory_, st->bind_address, peer_address,
+        &rand_generator_));
+    dispatcher_->addSession(st->bind_address, peer_address, st->session.get());
 
-  st->session->open();
-  st->session->setCallback(st);
+    st->session->open();
+    st->session->setCallback(st);
+  });
   return 0;
 }
 
@@ -203,6 +209,7 @@ int ProtocolStack::_accept(int socket, struct sockaddr *address,
   }
 
   while (true) {
+    st->clearMessage();
     st->waitMessage(guard);
     // LAB: insert your code here.
 
@@ -213,7 +220,9 @@ int ProtocolStack::_accept(int socket, struct sockaddr *address,
 
 /**
  * @brief Read up to `nbyte` from socket
- * @see SocketSession::receive, ProtocolStack::_write
+ * The bytes are taken from the receive ring of the socket, the loop thread
+ * refills it from the session without blocking the reader.
+ * @see SocketSession::receive, SocketStruct::fill, ProtocolStack::_write
  *
  * @param fildes
  * @param buf
@@ -221,8 +230,67 @@ int ProtocolStack::_accept(int socket, struct sockaddr *address,
  * @return ssize_t bytes read
  */
 ssize_t ProtocolStack::_read(int fildes, void *buf, size_t nbyte) {
-  // LAB: insert your code here.
+  if (!ownFD(fildes)) {
+    return __real_read(fildes, buf, nbyte);
+  }
+
+  SocketStruct *st;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    st = lookupStruct(fildes);
+
+    if (st->type == SocketStruct::Type::UNSPECIFIED) {
+      RETURN_ERRNO(ENOTCONN);
+    }
+
+    if (st->type != SocketStruct::Type::ACTIVE) {
+      RETURN_ERRNO(EBADF);
+    }
+  }
+
+  if (!openRings(st)) {
+    RETURN_ERRNO(ENOTCONN);
+  }
 
+  while (true) {
+    size_t rv = st->receive_ring->read((char *)buf, nbyte);
+    if (rv > 0) {
+      // the session may hold more bytes than the ring had room for
+      if (!st->fill_pending.exchange(true, std::memory_order_acq_rel)) {
+        epoll_server_->runInLoop([this, st] {
+          std::lock_guard<std::mutex> guard(mutex_);
+          st->fill_pending.store(false, std::memory_order_release);
+          st->fill();
+        });
+      }
+      return rv;
+    }
+
+    std::unique_lock<std::mutex> guard(mutex_);
+    // |fill| runs under |mutex_|, check again before waiting
+    st->clearMessage();
+    if (!st->receive_ring->empty()) {
+      continue;
+    }
+    if (st->closing) {
+      // a posted |fill| may not have run yet, and the session may hold
+      // more bytes than the ring, so drain it before reporting the end
+      guard.unlock();
+      epoll_server_->runInLoopAndWait([this, st] {
+        std::lock_guard<std::mutex> guard(mutex_);
+        st->fill();
+      });
+      if (!st->receive_ring->empty()) {
+        continue;
+      }
+      // end of file
+      return 0;
+    }
+    st->waitMessage(guard);
+    if (st->isErrorMessage() && !st->closing) {
+      RETURN_ERRNO(ECONNRESET);
+    }
+  }
 }
 
 ssize_t ProtocolStack::_write(int fildes, const void *buf, size_t nbyte) {
@@ -230,51 +298,127 @@ ssize_t ProtocolStack::_write(int fildes, const void *buf, size_t nbyte) {
     return __real_write(fildes, buf, nbyte);
   }
 
-  std::unique_lock<std::mutex> guard(mutex_);
-  SocketStruct *st = lookupStruct(fildes);
+  SocketStruct *st;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    st = lookupStruct(fildes);
 
-  if (st->type == SocketStruct::Type::UNSPECIFIED) {
-    RETURN_ERRNO(ENOTCONN);
-  }
+    if (st->type == SocketStruct::Type::UNSPECIFIED) {
+      RETURN_ERRNO(ENOTCONN);
+    }
 
-  if (st->type != SocketStruct::Type::ACTIVE) {
-    // The socket is not accepting connections.
-    RETURN_ERRNO(EBADF);
+    if (st->type != SocketStruct::Type::ACTIVE) {
+      // The socket is not accepting connections.
+      RETURN_ERRNO(EBADF);
+    }
   }
 
-  size_t rv = st->session->send((char *)buf, nbyte);
-  if (rv > 0) {
-    return rv;
+  if (!openRings(st)) {
+    RETURN_ERRNO(ENOTCONN);
   }
 
   while (true) {
-    st->waitMessage(guard);
-
-    if (st->message_ & SocketSession::WRITABLE) {
-      size_t rv = st->session->send((char *)buf, nbyte);
-      if (rv > 0) {
-        return rv;
+    size_t rv = st->send_ring->write((const char *)buf, nbyte);
+    if (rv > 0) {
+      if (!st->flush_pending.exchange(true, std::memory_order_acq_rel)) {
+        epoll_server_->runInLoop([this, st] {
+          std::lock_guard<std::mutex> guard(mutex_);
+          st->flush_pending.store(false, std::memory_order_release);
+          st->flush();
+        });
       }
+      return rv;
     }
 
+    std::unique_lock<std::mutex> guard(mutex_);
+    // |flush| runs under |mutex_|, check again before waiting
+    st->clearMessage();
+    if (st->send_ring->free() > 0) {
+      continue;
+    }
+    st->waitMessage(guard);
     if (st->isErrorMessage()) {
       RETURN_ERRNO(ECONNABORTED);
     }
   }
 }
 
+/**
+ * @brief Allocate the rings of an active socket on its first read or write.
+ * @return false if the socket has no session to stream through.
+ */
+bool ProtocolStack::openRings(SocketStruct *st) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (st->send_ring != nullptr) {
+      return true;
+    }
+  }
+  epoll_server_->runInLoopAndWait([this, st] {
+    std::lock_guard<std::mutex> guard(mutex_);
+    st->openRings();
+  });
+  std::lock_guard<std::mutex> guard(mutex_);
+  return st->send_ring != nullptr;
+}
+
 int ProtocolStack::_close(int fildes) {
   if (!ownFD(fildes)) {
     return __real_close(fildes);
   }
 
+  epoll_server_->runInLoopAndWait([this, fildes] { closeStruct(fildes); });
+  return 0;
+}
+
+/**
+ * @brief Close the sessions of closed sockets whose send rings are drained,
+ * or whose connections failed so the bytes can never be sent. Runs at the
+ * end of every loop iteration.
+ */
+void ProtocolStack::closeLingering() {
+  if (lingering_.empty()) {
+    return;
+  }
+
   std::lock_guard<std::mutex> guard(mutex_);
-  SocketStruct *st = lookupStruct(fildes);
+  const SocketSession::CallbackMessage kFailed =
+      SocketSession::RESET | SocketSession::REFUSED |
+      SocketSession::NOTEXIST | SocketSession::NOSERVICE;
+  bool closed = false;
+  for (auto iter = lingering_.begin(); iter != lingering_.end();) {
+    SocketStruct *st = iter->get();
+    if (st->send_ring != nullptr && !st->send_ring->empty() &&
+        (st->message_ & kFailed) == 0) {
+      iter++;
+      continue;
+    }
+    st->session->close();
+    garbage_.push_back(std::move(st->session));
+    iter = lingering_.erase(iter);
+    closed = true;
+  }
+  if (closed) {
+    // the devices were flushed earlier in this iteration
+    device_manager_->flush();
+  }
+}
+
+void ProtocolStack::closeStruct(int fd) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  SocketStruct *st = lookupStruct(fd);
 
   switch (st->type) {
   case SocketStruct::Type::UNSPECIFIED:
     break;
   case SocketStruct::Type::ACTIVE:
+    st->flush();
+    if (st->send_ring != nullptr && !st->send_ring->empty()) {
+      // |_write| reported these bytes as sent, the session takes them on
+      // WRITABLE and is closed by |closeLingering| once the ring is empty
+      lingering_.push_back(std::move(fd_set_[fd]));
+      break;
+    }
     st->session->close();
     garbage_.push_back(std::move(st->session));
     break;
@@ -287,9 +431,7 @@ int ProtocolStack::_close(int fildes) {
   default:
     LOG(FATAL) << "unknown socket type";
   }
-  removeStruct(fildes);
-
-  return 0;
+  removeStruct(fd);
 }
 
 int ProtocolStack::_getaddrinfo(const char *node, const char *service,
@@ -320,6 +462,8 @@ ProtocolStack::~ProtocolStack() {
     auto iter = fd_set_.begin();
     _close(iter->first);
   }
+  // stop the reactors before the layers they call into are destroyed
+  event_loops_->stop();
 }
 
 void ProtocolStack::closeAllFDs() {
@@ -328,4 +472,11 @@ void ProtocolStack::closeAllFDs() {
   }
 }
 
-bool ProtocolStack::canClose() { return garbage_.empty(); }
+void ProtocolStack::dumpStats(std::ostream &os) { event_loops_->dumpStats(os); }
+
+bool ProtocolStack::canClose() {
+  return epoll_server_->runInLoopAndWait([this] {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return garbage_.empty() && lingering_.empty();
+  });
+}
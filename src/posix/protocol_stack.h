@@ -7,10 +7,12 @@
 
 #include "../base/epoll_alarm_factory.h"
 #include "../base/epoll_server.h"
+#include "../base/epoll_server_group.h"
 #include "../base/util.h"
 #include "../ether/device_manager.h"
 #include "../ip/ip_layer.h"
 #include "../tcp/socket_session.h"
+#include "capture_filter.h"
 #include "listen_dispatcher.h"
 #include "reset_dispatcher.h"
 #include "segment_dispatcher.h"
@@ -58,22 +60,43 @@ public:
 
   bool canClose();
 
+  // Dump the event loop histograms, @see EpollServer::Stats
+  void dumpStats(std::ostream &os);
+
 private:
   ProtocolStack();
   ~ProtocolStack() override;
 
-  static void startEventLoop(EpollServer *epoll_server);
+  /* Loop 0 is the home of the stack: IPLayer, the dispatchers and every
+   * session live there. The device queues are spread over all loops, the
+   * other loops only read frames and hand them to the home loop, @see
+   * Device::registerToGroup. Sessions are not partitioned across loops,
+   * since they share the routing and dispatch state of the home loop.
+   */
+  static const size_t kEventLoops = 4;
 
+  /* Sessions and layers are only touched in the loop thread. POSIX calls
+   * run their work there with EpollServer::runInLoopAndWait and hold
+   * |mutex_| only to check the SocketStruct and to wait for its messages.
+   * Data goes through the rings of the SocketStruct and does not wait for
+   * the loop at all.
+   */
   std::mutex mutex_;
 
-  std::unique_ptr<EpollServer> epoll_server_;
+  std::unique_ptr<EpollServerGroup> event_loops_;
+  // owned by |event_loops_|
+  EpollServer *epoll_server_;
   std::unique_ptr<DeviceManager> device_manager_;
-  std::unique_ptr<AlarmFactory> alarm_factory_;
+  std::unique_ptr<CaptureFilter> capture_filter_;
+  // owned by |event_loops_|
+  AlarmFactory *alarm_factory_;
   std::unique_ptr<IPLayer> ip_layer_;
   RandGenerator rand_generator_;
   int null_fd_;
   std::unordered_map<int, std::unique_ptr<SocketStruct>> fd_set_;
   std::list<std::unique_ptr<SocketSession>> garbage_;
+  // closed sockets whose |send_ring| still has bytes for the session
+  std::list<std::unique_ptr<SocketStruct>> lingering_;
 
   /* note that dispatchers should be constructed after
    * other components because of the dependency. Thus,
@@ -92,6 +115,13 @@ private:
   SocketStruct *lookupStruct(int fd);
 
   void removeStruct(int fd);
+
+  bool openRings(SocketStruct *st);
+
+  // Close the sessions of |fd| in the loop thread.
+  void closeStruct(int fd);
+
+  void closeLingering();
 };
 
 #endif // SRC_POSIX_PROTOCOL_STACK_H
@@ -14,6 +14,14 @@ void ResetDispatcher::onReceivePacket(char *buffer, size_t length,
 
   std::unique_ptr<Segment> segment =
       Segment::parse(source, destination, buffer, length);
+  if (segment == nullptr) {
+    DLOG(ERROR) << "drop a malformed segment";
+    return;
+  }
+  // never answer a reset with a reset, RFC 793 section 3.4
+  if (segment->isRST()) {
+    return;
+  }
   SocketAddress &to = segment->destination_;
   SocketAddress &from = segment->source_;
 
@@ -31,7 +39,10 @@ void ResetDispatcher::onReceivePacket(char *buffer, size_t length,
   DLOG(INFO) << segment->toString();
 
   DataWriter writer(buffer_.get(), kMaxTCPPacketLength);
-  segment->writeSegmentTo(&writer);
+  if (!response->writeSegmentTo(&writer)) {
+    LOG(ERROR) << "drop a reset longer than a packet";
+    return;
+  }
 
   if (!ip_layer_->sendPacket(to.ipAddress(), from.ipAddress(),
                              ServiceProtocol::TCP, buffer_.get(),
@@ -3,6 +3,7 @@
 //
 
 #include "segment_dispatcher.h"
+#include "../base/layer_profile.h"
 #include "../tcp/segment.h"
 
 SegmentDispatcher::SegmentDispatcher(IPacketCallback *next) : next_(next) {
@@ -12,8 +13,13 @@ SegmentDispatcher::SegmentDispatcher(IPacketCallback *next) : next_(next) {
 void SegmentDispatcher::onReceivePacket(char *buffer, size_t length,
                                         IPAddress source,
                                         IPAddress destination) {
+  LayerProfile::Scope scope(LayerProfile::TRANSPORT);
   std::unique_ptr<Segment> segment =
       Segment::parse(source, destination, buffer, length);
+  if (segment == nullptr) {
+    DLOG(ERROR) << "drop a malformed segment";
+    return;
+  }
   SocketAddress &to = segment->destination_;
   SocketAddress &from = segment->source_;
 
@@ -24,7 +30,10 @@ void SegmentDispatcher::onReceivePacket(char *buffer, size_t length,
     return;
   }
 
-  // TODO: check the checksum
+  if (!session->stageSegment(segment.get())) {
+    DLOG(ERROR) << "drop a segment with a bad checksum";
+    return;
+  }
 
   session->onSegmentArrival(std::move(segment));
 }
@@ -5,9 +5,17 @@
 #include "socket_struct.h"
 
 SocketStruct::SocketStruct(const SocketAddress &address)
-    : backlog(0), bind_address(address), type(Type::UNSPECIFIED) {}
+    : backlog(0), bind_address(address), type(Type::UNSPECIFIED),
+      flush_pending(false), fill_pending(false), message_(0),
+      flushing_(false) {}
 
 void SocketStruct::onMessage(SocketSession::CallbackMessage message) {
+  if (message & SocketSession::WRITABLE) {
+    flush();
+  }
+  if (message & (SocketSession::READABLE | SocketSession::CLOSING)) {
+    fill();
+  }
   message_ |= message;
   if (message == SocketSession::CLOSING) {
     closing = true;
@@ -15,12 +23,78 @@ void SocketStruct::onMessage(SocketSession::CallbackMessage message) {
   cond_.notify_one();
 }
 
+void SocketStruct::clearMessage() { message_ = 0; }
+
 void SocketStruct::waitMessage(std::unique_lock<std::mutex> &mut) {
-  message_ = 0;
-  cond_.wait(mut);
+  cond_.wait(mut, [this] { return message_ != 0; });
 }
 
 bool SocketStruct::isErrorMessage() const {
   return message_ & ~static_cast<SocketSession::CallbackMessage>(
                         SocketSession::READABLE | SocketSession::WRITABLE);
 }
+
+void SocketStruct::openRings() {
+  if (type != Type::ACTIVE || session == nullptr || send_ring != nullptr) {
+    return;
+  }
+  send_ring = std::make_unique<SpscByteRing>(session->sendBufferSize());
+  receive_ring = std::make_unique<SpscByteRing>(session->receiveBufferSize());
+  // the bytes that arrived before the first read
+  fill();
+}
+
+void SocketStruct::flush() {
+  if (send_ring == nullptr || flushing_) {
+    // |session| may signal WRITABLE while it is sending our bytes
+    return;
+  }
+  flushing_ = true;
+  size_t flushed = 0;
+  char *data;
+  size_t length;
+  while ((length = send_ring->peek(&data)) > 0) {
+    size_t sent = session->send(data, length);
+    send_ring->consume(sent);
+    flushed += sent;
+    if (sent < length) {
+      // retry on the next WRITABLE message
+      break;
+    }
+  }
+  flushing_ = false;
+
+  if (flushed > 0) {
+    // wake up the writer waiting for free space
+    message_ |= SocketSession::WRITABLE;
+    cond_.notify_one();
+  }
+}
+
+void SocketStruct::fill() {
+  if (receive_ring == nullptr) {
+    return;
+  }
+  size_t filled = 0;
+  char *data;
+  size_t length;
+  while ((length = receive_ring->prepare(&data)) > 0) {
+    size_t received = session->receive(data, length);
+    receive_ring->commit(received);
+    filled += received;
+    if (received < length) {
+      break;
+    }
+  }
+
+  // the tuner measures what the application read, not what the loop moved
+  // into the ring, |_read| posts a |fill| after every read
+  session->adjustReceiveBuffer(receive_ring->capacity() -
+                               receive_ring->free());
+
+  if (filled > 0) {
+    // wake up the reader waiting for data
+    message_ |= SocketSession::READABLE;
+    cond_.notify_one();
+  }
+}
@@ -5,7 +5,9 @@
 #ifndef SRC_POSIX_SOCKET_STRUCT_H
 #define SRC_POSIX_SOCKET_STRUCT_H
 
+#include "../base/spsc_byte_ring.h"
 #include "../tcp/socket_session.h"
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 
@@ -37,15 +39,41 @@ public:
 
   bool closing = false;
 
+  /* Data of an active socket is handed over between the user thread and the
+   * loop thread through these rings, so |read| and |write| never wait for
+   * packet processing. The user thread writes |send_ring| and reads
+   * |receive_ring|, the loop thread moves the bytes from and to |session|.
+   * Both are null until the socket is first read or written, so listening
+   * and never-connected sockets hold no ring.
+   */
+  std::unique_ptr<SpscByteRing> send_ring;
+  std::unique_ptr<SpscByteRing> receive_ring;
+  // a |flush| or |fill| task is posted to the loop and has not run yet
+  std::atomic<bool> flush_pending;
+  std::atomic<bool> fill_pending;
+
+  // Allocate the rings sized like the buffers of |session| and fill the
+  // receive ring, called in the loop thread.
+  void openRings();
+  // Move bytes from |send_ring| to |session|, called in the loop thread.
+  void flush();
+  // Move bytes from |session| to |receive_ring|, called in the loop thread.
+  void fill();
+
   // use mutex and conditional variable to ensure exclusive access
   // and save CPU cycles
   bool isErrorMessage() const;
   void onMessage(SocketSession::CallbackMessage message) override;
+  void clearMessage();
+  // wait until a message arrives after the last |clearMessage|
   void waitMessage(std::unique_lock<std::mutex> &mut);
 
   std::condition_variable cond_;
 
   SocketSession::CallbackMessage message_;
+
+private:
+  bool flushing_;
 };
 
 #endif // SRC_POSIX_SOCKET_STRUCT_H
@@ -0,0 +1,69 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "receive_tuner.h"
+#include <algorithm>
+
+ReceiveTuner::ReceiveTuner(size_t min_size, size_t max_size)
+    : min_size_(min_size), max_size_(max_size), size_(min_size), rtt_seq_(0),
+      rtt_window_(0), rtt_start_(TimeBase::zero()),
+      rtt_(TimeBase::Delta::zero()), round_seq_(0),
+      round_start_(TimeBase::zero()), slow_rounds_(0) {
+  DCHECK(min_size <= max_size);
+}
+
+void ReceiveTuner::setLimits(size_t min_size, size_t max_size) {
+  DCHECK(min_size <= max_size);
+  min_size_ = min_size;
+  max_size_ = max_size;
+  size_ = std::min(std::max(size_, min_size_), max_size_);
+}
+
+void ReceiveTuner::onArrival(SequenceNumber next, size_t window,
+                             TimeBase now) {
+  if (rtt_start_.isInitialized()) {
+    if (next - rtt_seq_ < rtt_window_) {
+      return;
+    }
+    // an upper bound of the RTT, keep the smallest one recently seen
+    TimeBase::Delta sample = now - rtt_start_;
+    if (rtt_.isZero() || sample < rtt_) {
+      rtt_ = sample;
+    } else {
+      rtt_ = rtt_ + (sample - rtt_) * 0.125;
+    }
+  }
+  rtt_seq_ = next;
+  rtt_window_ = std::max<size_t>(window, 1);
+  rtt_start_ = now;
+}
+
+size_t ReceiveTuner::onDrain(SequenceNumber drained, TimeBase now) {
+  if (rtt_.isZero()) {
+    return size_;
+  }
+  if (!round_start_.isInitialized()) {
+    round_seq_ = drained;
+    round_start_ = now;
+    return size_;
+  }
+  if (now - round_start_ < rtt_) {
+    return size_;
+  }
+
+  const size_t copied = drained - round_seq_;
+  round_seq_ = drained;
+  round_start_ = now;
+
+  if (copied * 2 > size_) {
+    size_ = std::min(copied * 2, max_size_);
+    slow_rounds_ = 0;
+  } else if (copied * 4 >= size_) {
+    slow_rounds_ = 0;
+  } else if (++slow_rounds_ >= kShrinkRounds) {
+    size_ = std::max(size_ / 2, min_size_);
+    slow_rounds_ = 0;
+  }
+  return size_;
+}
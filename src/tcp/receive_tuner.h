@@ -0,0 +1,59 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_TCP_RECEIVE_TUNER_H
+#define SRC_TCP_RECEIVE_TUNER_H
+
+#include "../base/time_base.h"
+#include "../base/util.h"
+#include "type.h"
+
+/**
+ * @brief Dynamic right-sizing of the receive buffer.
+ * The RTT is estimated on the receiver side as the time the peer takes to
+ * send one advertised window of data. Every RTT the tuner measures how many
+ * bytes the application drained and sizes the buffer to twice that amount,
+ * so the sender is never limited by the window while the application keeps
+ * up. The buffer is halved after the application stayed slow for
+ * |kShrinkRounds| rounds.
+ */
+class ReceiveTuner {
+public:
+  DISALLOW_COPY_AND_ASSIGN(ReceiveTuner)
+
+  ReceiveTuner(size_t min_size, size_t max_size);
+
+  void setLimits(size_t min_size, size_t max_size);
+
+  // Data up to |next| arrived, |window| bytes are advertised after it.
+  void onArrival(SequenceNumber next, size_t window, TimeBase now);
+
+  // The application drained the data up to |drained|, return the new size.
+  size_t onDrain(SequenceNumber drained, TimeBase now);
+
+  inline size_t size() const { return size_; }
+  inline size_t minSize() const { return min_size_; }
+  inline size_t maxSize() const { return max_size_; }
+  inline TimeBase::Delta rtt() const { return rtt_; }
+
+  static const int kShrinkRounds = 8;
+
+private:
+  size_t min_size_;
+  size_t max_size_;
+  size_t size_;
+
+  // the RTT sample in progress
+  SequenceNumber rtt_seq_;
+  size_t rtt_window_;
+  TimeBase rtt_start_;
+  TimeBase::Delta rtt_;
+
+  // the drain round in progress
+  SequenceNumber round_seq_;
+  TimeBase round_start_;
+  int slow_rounds_;
+};
+
+#endif // SRC_TCP_RECEIVE_TUNER_H
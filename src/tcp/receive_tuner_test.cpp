@@ -0,0 +1,69 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "receive_tuner.h"
+#include "gtest/gtest.h"
+
+class ReceiveTunerTest : public testing::Test {
+protected:
+  ReceiveTunerTest()
+      : tuner_(kMin, kMax), now_(TimeBase(1000 * 1000)), next_(1000),
+        drained_(1000) {}
+
+  /* The peer sends a full window every RTT and the application drains
+   * |rate| bytes per RTT. Run for |rounds| RTTs.
+   */
+  void run(size_t rate, int rounds) {
+    for (int i = 0; i < rounds; i++) {
+      next_ += rate;
+      drained_ += rate;
+      now_ = now_ + kRtt;
+      tuner_.onArrival(next_, rate, now_);
+      tuner_.onDrain(drained_, now_);
+    }
+  }
+
+  const size_t kMin = 16 * 1024;
+  const size_t kMax = 1024 * 1024;
+  const TimeBase::Delta kRtt = TimeBase::Delta::fromMilliseconds(10);
+
+  ReceiveTuner tuner_;
+  TimeBase now_;
+  SequenceNumber next_;
+  SequenceNumber drained_;
+};
+
+TEST_F(ReceiveTunerTest, Rtt) {
+  EXPECT_TRUE(tuner_.rtt().isZero());
+  run(kMin / 2, 3);
+  EXPECT_EQ(tuner_.rtt(), kRtt);
+  // the application drains half of the buffer per RTT
+  EXPECT_EQ(tuner_.size(), kMin);
+}
+
+TEST_F(ReceiveTunerTest, Grow) {
+  run(kMin, 2);
+  // the application keeps up with the window, double it every round
+  for (size_t expected = kMin * 2; expected <= kMax; expected *= 2) {
+    run(tuner_.size(), 1);
+    EXPECT_EQ(tuner_.size(), expected);
+  }
+  run(tuner_.size(), 1);
+  EXPECT_EQ(tuner_.size(), kMax);
+}
+
+TEST_F(ReceiveTunerTest, Shrink) {
+  run(kMin, 2);
+  run(kMin * 2, 1);
+  run(kMin * 4, 1);
+  EXPECT_EQ(tuner_.size(), kMin * 8);
+
+  // a slow application, the buffer shrinks slowly down to the minimum
+  run(kMin / 4, ReceiveTuner::kShrinkRounds - 1);
+  EXPECT_EQ(tuner_.size(), kMin * 8);
+  run(kMin / 4, ReceiveTuner::kShrinkRounds * 2);
+  EXPECT_LT(tuner_.size(), kMin * 8);
+  run(kMin / 4, ReceiveTuner::kShrinkRounds * 100);
+  EXPECT_EQ(tuner_.size(), kMin);
+}
@@ -7,25 +7,83 @@
 #include "../base/data_reader.h"
 #include "../ip/ip_address.h"
 #include "../ip/ip_layer.h"
+#include "tcp_header.h"
+#include <algorithm>
+
+namespace {
+
+const uint8_t kOptionEnd = 0;
+const uint8_t kOptionNoOperation = 1;
+const uint8_t kOptionWindowScale = 3;
+const uint8_t kMaxWindowScale = 14;
+
+/**
+ * @brief Parse the options between the fixed header and |offset|.
+ * Only the window scale option is understood, others are skipped.
+ */
+void parseOptions(Segment *segment, const uint8_t *buf, size_t offset) {
+  size_t i = kTcpHeaderLength;
+  while (i < offset) {
+    uint8_t kind = buf[i];
+    if (kind == kOptionEnd) {
+      break;
+    }
+    if (kind == kOptionNoOperation) {
+      i++;
+      continue;
+    }
+    if (i + 1 >= offset || buf[i + 1] < 2) {
+      // malformed
+      break;
+    }
+    uint8_t length = buf[i + 1];
+    if (kind == kOptionWindowScale && length == 3 && i + 2 < offset) {
+      segment->window_scale_ = static_cast<int8_t>(
+          std::min(buf[i + 2], kMaxWindowScale));
+    }
+    i += length;
+  }
+}
+
+} // namespace
 
 bool Segment::writeSegmentTo(DataWriter *writer) {
-  writer->writeUInt16(source_.port());
-  writer->writeUInt16(destination_.port());
-  writer->writeUInt32(sequence_);
-  writer->writeUInt32(acknowledgment_);
-  writer->writeUInt8(0x50);
-  writer->writeUInt8(flags_);
-  writer->writeUInt16(window_);
+  // the window scale option is only sent on SYN
+  const bool scale = isSYN() && window_scale_ >= 0;
+  const size_t header_length = kTcpHeaderLength + (scale ? 4 : 0);
 
+  char *header = writer->writeHeader<TcpHeader>();
+  if (header == nullptr) {
+    return false;
+  }
+  TcpHeader::SourcePort::store(header, source_.port());
+  TcpHeader::DestinationPort::store(header, destination_.port());
+  TcpHeader::Sequence::store(header, sequence_);
+  TcpHeader::Acknowledgment::store(header, acknowledgment_);
+  TcpHeader::DataOffset::store(header, header_length << 2u);
+  TcpHeader::Flags::store(header, flags_);
+  TcpHeader::Window::store(header, window_);
   // leave the checksum field as 0
-  writer->writeUInt16(0);
+  TcpHeader::Checksum::store(header, 0);
+  TcpHeader::UrgentPointer::store(header, 0);
+  if (scale) {
+    writer->writeUInt8(kOptionNoOperation);
+    writer->writeUInt8(kOptionWindowScale);
+    writer->writeUInt8(3);
+    writer->writeUInt8(window_scale_);
+  }
+  Checksum checksum(writer->begin(), writer->end());
 
-  // urgent pointer = 0
-  writer->writeUInt16(0);
-  writer->writeBytes(data_, data_length_);
+  // sum the payload while copying it into the packet
+  char *payload = writer->reserve(data_length_);
+  if (payload == nullptr) {
+    return false;
+  }
+  if (data_length_ > 0) {
+    checksum.copyAndAdd(payload, data_, data_ + data_length_);
+  }
 
-  uint16_t tcp_length = data_length_ + kTcpHeaderLength;
-  Checksum checksum(writer->begin(), writer->end());
+  uint16_t tcp_length = data_length_ + header_length;
 
   // now add the 96 bit pseudo header
   checksum.addIPAddress(source_.ipAddress());
@@ -33,34 +91,73 @@ bool Segment::writeSegmentTo(DataWriter *writer) {
   checksum.addHostUInt16((uint16_t)ServiceProtocol::TCP);
   checksum.addHostUInt16(tcp_length);
 
-  checksum.writeTo(writer->begin() + 16);
-
-  return false;
+  checksum.writeTo(header + TcpHeader::Checksum::kOffset);
+  return true;
 }
 
 std::unique_ptr<Segment> Segment::parse(IPAddress source, IPAddress destination,
                                         char *buf, size_t len) {
-  std::unique_ptr<Segment> rv = std::make_unique<Segment>();
   DataReader reader(buf, len);
-  SocketPort source_port;
-  SocketPort destination_port;
-  reader.readUInt16(&source_port);
-  reader.readUInt16(&destination_port);
-  rv->source_ = SocketAddress(source, source_port);
-  rv->destination_ = SocketAddress(destination, destination_port);
-  reader.readUInt32(&rv->sequence_);
-  reader.readUInt32(&rv->acknowledgment_);
-  uint8_t offset;
-  reader.readUInt8(&offset);
-  offset = offset >> 2u;
-  reader.readUInt8(&rv->flags_);
-  DCHECK(reader.readUInt16(&rv->window_));
+  const char *header = reader.readHeader<TcpHeader>();
+  if (header == nullptr) {
+    return nullptr;
+  }
+  size_t offset = TcpHeader::DataOffset::load(header) >> 2u;
+  if (offset < kTcpHeaderLength || offset > len) {
+    return nullptr;
+  }
+
+  std::unique_ptr<Segment> rv = std::make_unique<Segment>();
+  rv->source_ = SocketAddress(source, TcpHeader::SourcePort::load(header));
+  rv->destination_ =
+      SocketAddress(destination, TcpHeader::DestinationPort::load(header));
+  rv->sequence_ = TcpHeader::Sequence::load(header);
+  rv->acknowledgment_ = TcpHeader::Acknowledgment::load(header);
+  rv->flags_ = TcpHeader::Flags::load(header);
+  rv->window_ = TcpHeader::Window::load(header);
+  if (offset > kTcpHeaderLength) {
+    parseOptions(rv.get(), reinterpret_cast<uint8_t *>(buf), offset);
+  }
   rv->own_data_ = false;
   rv->data_ = buf + offset;
   rv->data_length_ = len - offset;
+  rv->header_length_ = offset;
+
+  rv->header_checksum_.add(buf, buf + offset);
   return rv;
 }
 
+/**
+ * @brief The sum of the header and the pseudo header of a parsed segment.
+ * The pseudo header is added only here, so parsing a segment between
+ * addresses we cannot sum, e.g. in tests, does not abort.
+ */
+Checksum Segment::headerChecksum() const {
+  Checksum checksum = header_checksum_;
+  checksum.addIPAddress(source_.ipAddress());
+  checksum.addIPAddress(destination_.ipAddress());
+  checksum.addHostUInt16((uint16_t)ServiceProtocol::TCP);
+  checksum.addHostUInt16(header_length_ + data_length_);
+  return checksum;
+}
+
+bool Segment::verifyChecksum() const {
+  Checksum checksum = headerChecksum();
+  checksum.add(data_, data_ + data_length_);
+  return checksum.getChecksum() == 0xffff;
+}
+
+bool Segment::moveDataTo(char *destination) {
+  Checksum checksum = headerChecksum();
+  checksum.copyAndAdd(destination, data_, data_ + data_length_);
+  if (own_data_) {
+    delete[] data_;
+    own_data_ = false;
+  }
+  data_ = destination;
+  return checksum.getChecksum() == 0xffff;
+}
+
 Segment::~Segment() {
   if (own_data_) {
     delete[] data_;
@@ -84,7 +181,7 @@ void Segment::copyData() {
     return;
   }
 
-  char *data = (char *)malloc(data_length_);
+  char *data = new char[data_length_];
   std::copy(data_, data_ + data_length_, data);
   own_data_ = true;
   data_ = data;
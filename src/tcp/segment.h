@@ -5,6 +5,7 @@
 #ifndef SRC_TCP_SEGMENT_H
 #define SRC_TCP_SEGMENT_H
 
+#include "../base/checksum.h"
 #include "../base/data_writer.h"
 #include "../ip/ip_address.h"
 #include "socket_address.h"
@@ -53,6 +54,7 @@ public:
   Segment() = default;
   ~Segment();
 
+  // Write the segment with its checksum, false if |writer| is too short.
   bool writeSegmentTo(DataWriter *writer);
   bool writeDataTo(DataWriter *writer);
 
@@ -61,13 +63,24 @@ public:
   inline bool isFIN() const { return flags_ & FIN; }
   inline bool isSYN() const { return flags_ & SYN; }
 
-  // Note that we don't copy the data in |buf|.
+  /* Note that we don't copy the data in |buf|.
+   * nullptr if |buf| is shorter than the header or its data offset is bad.
+   */
   static std::unique_ptr<Segment> parse(IPAddress source, IPAddress destination,
                                         char *buf, size_t len);
 
   // Copy |data_| if we don't own it.
   void copyData();
 
+  // Verify the checksum of a parsed segment.
+  bool verifyChecksum() const;
+
+  /**
+   * @brief Copy the payload of a parsed segment to |destination| and verify
+   * the checksum in the same pass. |data_| points to |destination| then.
+   */
+  bool moveDataTo(char *destination);
+
   enum {
     FIN = 0x01,
     SYN = 0x02,
@@ -85,12 +98,21 @@ public:
   SegmentFlags flags_;
 
   WindowSize window_;
+  // the shift of the window scale option (RFC 7323) on SYN, -1 if absent
+  int8_t window_scale_ = -1;
 
   char *data_;
   bool own_data_;
   size_t data_length_;
 
   std::string toString() const;
+
+private:
+  Checksum headerChecksum() const;
+
+  // the header of a parsed segment
+  Checksum header_checksum_;
+  size_t header_length_ = 0;
 };
 
 std::ostream &operator<<(std::ostream &stream, const Segment &seg);
@@ -3,9 +3,33 @@
 //
 
 #include "segment_factory.h"
+#include <limits>
 
 SegmentFactory::SegmentFactory(SocketAddress local, SocketAddress remote)
-    : local_address_(local), remote_address_(remote) {}
+    : local_address_(local), remote_address_(remote), receive_buffer_(nullptr),
+      offered_shift_(-1), window_shift_(0), advertised_(false),
+      right_edge_(0) {}
+
+void SegmentFactory::onPeerWindowScale(int8_t shift) {
+  if (shift < 0) {
+    // do not offer the option in our SYN-ACK either
+    offered_shift_ = -1;
+  }
+  window_shift_ = offered_shift_ > 0 ? offered_shift_ : 0;
+}
+
+WindowSize SegmentFactory::window(SegmentFlags ctl) const {
+  const size_t kMaxWindow = std::numeric_limits<WindowSize>::max();
+  if (receive_buffer_ == nullptr) {
+    return kMaxWindow;
+  }
+  // the window field of a SYN is never scaled
+  size_t window = receive_buffer_->free();
+  if ((ctl & Segment::SYN) == 0) {
+    window >>= window_shift_;
+  }
+  return window < kMaxWindow ? window : kMaxWindow;
+}
 
 std::unique_ptr<Segment> SegmentFactory::createSegment(SequenceNumber seq,
                                                        SequenceNumber ack,
@@ -19,11 +43,27 @@ std::unique_ptr<Segment> SegmentFactory::createSegment(SequenceNumber seq,
   segment->acknowledgment_ = ack;
   segment->flags_ = ctl;
 
-  // We don't implement the flow control so far.
-  segment->window_ = 65535;
+  segment->window_ = window(ctl);
+  if (ctl & Segment::SYN) {
+    segment->window_scale_ = offered_shift_;
+  }
+  if (ctl & Segment::ACK) {
+    const uint8_t shift = (ctl & Segment::SYN) ? 0 : window_shift_;
+    SequenceNumber edge =
+        ack + (static_cast<SequenceNumber>(segment->window_) << shift);
+    if (!advertised_ || static_cast<int32_t>(edge - right_edge_) > 0) {
+      right_edge_ = edge;
+      advertised_ = true;
+    }
+  }
 
   segment->data_ = data;
   segment->own_data_ = false;
   segment->data_length_ = data_length;
   return segment;
 }
+
+bool SegmentFactory::advertisedEdge(SequenceNumber *edge) const {
+  *edge = right_edge_;
+  return advertised_;
+}
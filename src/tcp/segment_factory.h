@@ -5,6 +5,7 @@
 #ifndef TCPSTACK_SEGMENTFACTORY_H
 #define TCPSTACK_SEGMENTFACTORY_H
 
+#include "../base/mirrored_ring_buffer.h"
 #include "../base/util.h"
 #include "../ip/ip_address.h"
 #include "segment.h"
@@ -37,6 +38,30 @@ public:
                                          SegmentFlags ctl, char *data,
                                          size_t data_length);
 
+  // Advertise the free space of |buffer| as the receive window.
+  inline void setReceiveBuffer(const MirroredRingBuffer *buffer) {
+    receive_buffer_ = buffer;
+  }
+
+  // Offer |shift| in the window scale option of our SYN, -1 for none.
+  inline void offerWindowScale(int8_t shift) { offered_shift_ = shift; }
+
+  /**
+   * @brief Called on the SYN of the peer. The window is scaled only if both
+   * sides sent the option, @see RFC 7323 section 2.2
+   */
+  void onPeerWindowScale(int8_t shift);
+
+  // The window field of a segment with flags |ctl|.
+  WindowSize window(SegmentFlags ctl) const;
+
+  /**
+   * @brief The furthest right edge of the receive window advertised so far.
+   * The window must not be retracted behind it, @see RFC 7323 section 2.4
+   * @return false if no ACK has been created yet
+   */
+  bool advertisedEdge(SequenceNumber *edge) const;
+
   inline SocketAddress getLocalAddress() const { return local_address_; }
 
   inline SocketAddress getRemoteAddress() const { return remote_address_; }
@@ -44,6 +69,14 @@ public:
 private:
   SocketAddress local_address_;
   SocketAddress remote_address_;
+
+  // not owned, nullptr to advertise the maximum window
+  const MirroredRingBuffer *receive_buffer_;
+  int8_t offered_shift_;
+  // applied to the window of non-SYN segments once negotiated
+  uint8_t window_shift_;
+  bool advertised_;
+  SequenceNumber right_edge_;
 };
 
 #endif // TCPSTACK_SEGMENTFACTORY_H
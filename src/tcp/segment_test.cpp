@@ -0,0 +1,133 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#include "segment.h"
+#include "tcp_header.h"
+#include "gtest/gtest.h"
+
+class SegmentTest : public ::testing::Test {
+protected:
+  SegmentTest()
+      : source_("10.0.0.1", 1234), destination_("10.0.0.2", 80), buf_() {}
+
+  size_t write(Segment *segment) {
+    DataWriter writer(buf_, sizeof(buf_));
+    EXPECT_TRUE(segment->writeSegmentTo(&writer));
+    return writer.bytesWritten();
+  }
+
+  std::unique_ptr<Segment> parse(size_t length) {
+    return Segment::parse(source_.ipAddress(), destination_.ipAddress(), buf_,
+                          length);
+  }
+
+  SocketAddress source_;
+  SocketAddress destination_;
+  char buf_[kMaxTCPPacketLength];
+};
+
+TEST_F(SegmentTest, RoundTrip) {
+  char data[] = "hello";
+  Segment segment;
+  segment.source_ = source_;
+  segment.destination_ = destination_;
+  segment.sequence_ = 0x01020304;
+  segment.acknowledgment_ = 0xfffffffe;
+  segment.flags_ = Segment::SYN | Segment::ACK;
+  segment.window_ = 0xabcd;
+  segment.window_scale_ = 7;
+  segment.data_ = data;
+  segment.own_data_ = false;
+  segment.data_length_ = sizeof(data);
+
+  size_t length = write(&segment);
+  // the window scale option is padded to 24 bytes
+  EXPECT_EQ(length, 24 + sizeof(data));
+  EXPECT_EQ(TcpHeader::SourcePort::load(buf_), 1234);
+  EXPECT_EQ(TcpHeader::DataOffset::load(buf_), 6u << 4u);
+
+  std::unique_ptr<Segment> parsed = parse(length);
+  ASSERT_NE(parsed, nullptr);
+  EXPECT_TRUE(parsed->source_ == source_);
+  EXPECT_TRUE(parsed->destination_ == destination_);
+  EXPECT_EQ(parsed->sequence_, 0x01020304u);
+  EXPECT_EQ(parsed->acknowledgment_, 0xfffffffeu);
+  EXPECT_EQ(parsed->flags_, Segment::SYN | Segment::ACK);
+  EXPECT_EQ(parsed->window_, 0xabcd);
+  EXPECT_EQ(parsed->window_scale_, 7);
+  EXPECT_EQ(parsed->data_length_, sizeof(data));
+  EXPECT_STREQ(parsed->data_, data);
+  EXPECT_TRUE(parsed->verifyChecksum());
+}
+
+TEST_F(SegmentTest, Malformed) {
+  Segment segment;
+  segment.source_ = source_;
+  segment.destination_ = destination_;
+  segment.sequence_ = 0;
+  segment.acknowledgment_ = 0;
+  segment.flags_ = Segment::ACK;
+  segment.window_ = 0;
+  segment.data_ = nullptr;
+  segment.own_data_ = false;
+  segment.data_length_ = 0;
+
+  size_t length = write(&segment);
+  ASSERT_EQ(length, kTcpHeaderLength);
+  EXPECT_NE(parse(length), nullptr);
+  EXPECT_EQ(parse(length - 1), nullptr);
+
+  // the data offset points past the end
+  TcpHeader::DataOffset::store(buf_, 6u << 4u);
+  EXPECT_EQ(parse(length), nullptr);
+  // the data offset is shorter than the fixed header
+  TcpHeader::DataOffset::store(buf_, 4u << 4u);
+  EXPECT_EQ(parse(length), nullptr);
+}
+
+TEST_F(SegmentTest, Checksum) {
+  char data[] = "hello";
+  Segment segment;
+  segment.source_ = source_;
+  segment.destination_ = destination_;
+  segment.sequence_ = 1;
+  segment.acknowledgment_ = 1;
+  segment.flags_ = Segment::ACK;
+  segment.window_ = 1;
+  segment.data_ = data;
+  segment.own_data_ = false;
+  segment.data_length_ = sizeof(data);
+  size_t length = write(&segment);
+
+  char staged[sizeof(data)];
+  std::unique_ptr<Segment> parsed = parse(length);
+  ASSERT_TRUE(parsed->moveDataTo(staged));
+  EXPECT_EQ(parsed->data_, staged);
+  EXPECT_STREQ(staged, data);
+
+  buf_[length - 1] ^= 1;
+  EXPECT_FALSE(parse(length)->verifyChecksum());
+
+  // the pseudo header is summed only when the checksum is verified
+  EXPECT_NE(Segment::parse(IPAddress(), IPAddress(), buf_, length), nullptr);
+}
+
+TEST_F(SegmentTest, ShortWriter) {
+  char data[] = "hello";
+  Segment segment;
+  segment.source_ = source_;
+  segment.destination_ = destination_;
+  segment.sequence_ = 1;
+  segment.acknowledgment_ = 1;
+  segment.flags_ = Segment::ACK;
+  segment.window_ = 1;
+  segment.data_ = data;
+  segment.own_data_ = false;
+  segment.data_length_ = sizeof(data);
+
+  DataWriter header_only(buf_, kTcpHeaderLength);
+  EXPECT_FALSE(segment.writeSegmentTo(&header_only));
+  DataWriter too_short(buf_, kTcpHeaderLength - 1);
+  EXPECT_FALSE(segment.writeSegmentTo(&too_short));
+}
@@ -7,14 +7,12 @@
 
 SendBuffer::SendBuffer(IPLayer *ip_layer, AlarmFactory *alarm_factory,
                        SegmentFactory *segment_factory, ControlBlock *tcb)
-    : ip_layer_(ip_layer),
-      retransmission_alarm_(alarm_factory->createAlarm(
-          std::make_unique<RetransmissionAlarmDelegate>(this))),
-      alarm_factory_(alarm_factory), segment_factory_(segment_factory),
-      buffer_(1024 * 256 /* 256 KB */), SYN_(CtlState::None),
-      FIN_(CtlState::None), tcb_(tcb), bytes_in_flight_(0) {
-  retransmission_alarm_->set(alarm_factory->now() +
-                             TimeBase::Delta::fromSeconds(1));
+    : buffer_(1024 * 256 /* 256 KB */), tcb_(tcb), SYN_(CtlState::None),
+      FIN_(CtlState::None), bytes_in_flight_(0), alarm_factory_(alarm_factory),
+      segment_factory_(segment_factory), ip_layer_(ip_layer),
+      retransmission_alarm_(alarm_factory, this) {
+  retransmission_alarm_.set(alarm_factory->now() +
+                            TimeBase::Delta::fromSeconds(1));
 }
 
 void SendBuffer::sendSYN(SequenceNumber initial) {
@@ -58,7 +56,10 @@ bool SendBuffer::sendSegment(Segment *segment) {
 
   char buf[kMaxTCPPacketLength];
   DataWriter writer(buf, kMaxTCPPacketLength);
-  segment->writeSegmentTo(&writer);
+  if (!segment->writeSegmentTo(&writer)) {
+    LOG(ERROR) << "drop a segment longer than a packet";
+    return false;
+  }
 
   if (!ip_layer_->sendPacket(source_, destination_, ServiceProtocol::TCP, buf,
                              writer.bytesWritten())) {
@@ -88,15 +89,15 @@ void SendBuffer::acknowledge(SequenceNumber ack) {
 
   if (bytes_in_flight_ == 0) {
     // All our sent data have been acked.
-    retransmission_alarm_->update(alarm_factory_->now() +
-                                  TimeBase::Delta::fromSeconds(1));
+    retransmission_alarm_.update(alarm_factory_->now() +
+                                 TimeBase::Delta::fromSeconds(1));
   }
 
   if (FIN_ == CtlState::Sent) {
     if (tcb_->send.equal(ack, tcb_->send.next)) {
       DCHECK(buffer_.empty());
       FIN_ = CtlState::Acked;
-      retransmission_alarm_->cancel();
+      retransmission_alarm_.cancel();
       tcb_->send.unack += 1;
     }
   }
@@ -115,9 +116,15 @@ void SendBuffer::transmit() {
     return transmit_SYN();
   }
 
-  char buf[kMaxTCPPacketLength];
   while (bytes_in_flight_ < kMaxBytesInFlight) {
-    size_t length = buffer_.read_offset(bytes_in_flight_, buf, kMaxSegmentSize);
+    // segments point into the ring, the payload is copied only once into the
+    // packet by |sendSegment|
+    size_t length = 0;
+    if (buffer_.remaining() > bytes_in_flight_) {
+      length = std::min(buffer_.remaining() - bytes_in_flight_,
+                        kMaxSegmentSize);
+    }
+    char *data = buffer_.peek(bytes_in_flight_);
     SequenceNumber seq = tcb_->send.unack + bytes_in_flight_;
 
     bytes_in_flight_ += length;
@@ -133,7 +140,7 @@ void SendBuffer::transmit() {
     }
 
     auto segment = segment_factory_->createSegment(seq, tcb_->receive.next,
-                                                   flags, buf, length);
+                                                   flags, data, length);
     if (!sendSegment(segment.get())) {
       return;
     }
@@ -159,6 +166,6 @@ void SendBuffer::transmit_SYN() {
 void SendBuffer::retransmit() {
   bytes_in_flight_ = 0;
   transmit();
-  retransmission_alarm_->set(alarm_factory_->now() +
-                             TimeBase::Delta::fromSeconds(1));
+  retransmission_alarm_.set(alarm_factory_->now() +
+                            TimeBase::Delta::fromSeconds(1));
 }
@@ -5,7 +5,7 @@
 #ifndef SRC_TCP_SENDING_QUEUE_H
 #define SRC_TCP_SENDING_QUEUE_H
 
-#include "../base/ring_buffer.h"
+#include "../base/mirrored_ring_buffer.h"
 #include "../base/util.h"
 #include "../ip/ip_layer.h"
 #include "control_block.h"
@@ -56,6 +56,8 @@ public:
 
   inline bool FIN_acked() const { return FIN_ == CtlState::Acked; }
 
+  inline size_t capacity() const { return buffer_.capacity(); }
+
 private:
   static constexpr size_t kMaxBytesInFlight = kMaxSegmentSize * 10;
 
@@ -69,7 +71,7 @@ private:
    */
   void retransmit();
 
-  RingBuffer buffer_;
+  MirroredRingBuffer buffer_;
 
   ControlBlock *tcb_;
 
@@ -92,8 +94,7 @@ private:
 
   IPLayer *ip_layer_;
 
-  DEFINE_ALARM_DELEGATE(RetransmissionAlarmDelegate, SendBuffer, retransmit);
-  std::unique_ptr<Alarm> retransmission_alarm_;
+  MemberAlarm<SendBuffer, &SendBuffer::retransmit> retransmission_alarm_;
 };
 
 #endif // SRC_TCP_SENDING_QUEUE_H
@@ -4,6 +4,15 @@
 //
 
 #include "socket_session.h"
+#include <limits>
+
+namespace {
+
+// default bounds of the receive buffer
+const size_t kMinReceiveBuffer = kMaxSegmentSize * 10;
+const size_t kMaxReceiveBuffer = 1024 * 1024 * 4; /* 4 MB */
+
+} // namespace
 
 SocketSession::SocketSession(IPLayer *ip_layer, AlarmFactory *alarm_factory,
                              SocketAddress local, SocketAddress remote,
@@ -11,10 +20,47 @@ SocketSession::SocketSession(IPLayer *ip_layer, AlarmFactory *alarm_factory,
     : factory_(local, remote), send_buffer_(std::make_unique<SendBuffer>(
                                    ip_layer, alarm_factory, &factory_, &tcb_)),
       output_(ip_layer), rand_generator_(rand), callback_(nullptr),
-      receive_buffer_(std::make_unique<RingBuffer>(kMaxSegmentSize * 10)),
-      time_wait_alarm_(
-          alarm_factory->createAlarm(std::make_unique<TimeWaitDelegate>(this))),
-      alarm_factory_(alarm_factory) {}
+      receive_buffer_(std::make_unique<MirroredRingBuffer>(kMinReceiveBuffer)),
+      receive_tuner_(kMinReceiveBuffer, kMaxReceiveBuffer),
+      alarm_factory_(alarm_factory), time_wait_alarm_(alarm_factory, this) {
+  factory_.setReceiveBuffer(receive_buffer_.get());
+  setReceiveBufferLimits(kMinReceiveBuffer, kMaxReceiveBuffer);
+}
+
+void SocketSession::setReceiveBufferLimits(size_t min_size, size_t max_size) {
+  receive_tuner_.setLimits(min_size, max_size);
+  // the smallest shift that can advertise the whole buffer
+  int8_t shift = 0;
+  while ((max_size >> shift) > std::numeric_limits<WindowSize>::max()) {
+    shift++;
+  }
+  factory_.offerWindowScale(shift);
+}
+
+void SocketSession::adjustReceiveBuffer(size_t unread) {
+  if (!tcb_.receive.SYN_received) {
+    return;
+  }
+  size_t size = receive_tuner_.onDrain(
+      tcb_.receive.next - receive_buffer_->remaining() - unread,
+      alarm_factory_->now());
+
+  /* Grow at once. Shrink only when the buffer is empty and the smaller
+   * window still reaches the right edge we advertised, so the window never
+   * retracts over data the peer may already have sent.
+   */
+  SequenceNumber edge;
+  bool retracts = factory_.advertisedEdge(&edge) &&
+                  static_cast<SequenceNumber>(edge - tcb_.receive.next) > size;
+  if (size > receive_buffer_->capacity() ||
+      (size * 2 <= receive_buffer_->capacity() && receive_buffer_->empty() &&
+       !retracts)) {
+    auto buffer = std::make_unique<MirroredRingBuffer>(size);
+    buffer->write(receive_buffer_->peek(), receive_buffer_->remaining());
+    receive_buffer_ = std::move(buffer);
+    factory_.setReceiveBuffer(receive_buffer_.get());
+  }
+}
 
 void SocketSession::setCallback(SocketSession::Callback *callback) {
   callback_ = callback;
@@ -31,6 +77,23 @@ void SocketSession::signalUser(CallbackMessage message) {
   }
 }
 
+/**
+ * @brief Verify the checksum of an arriving segment. An in-order payload
+ * that fits the receive buffer is copied to its free space in the same pass,
+ * so writing it to the buffer later does not copy it again.
+ * Nothing beyond the end of the buffer is live, so a corrupted segment
+ * copied there overwrites no data.
+ */
+bool SocketSession::stageSegment(Segment *segment) {
+  const size_t length = segment->data_length_;
+  if (length > 0 && tcb_.receive.SYN_received &&
+      segment->sequence_ == tcb_.receive.next &&
+      length <= receive_buffer_->free()) {
+    return segment->moveDataTo(receive_buffer_->prepare());
+  }
+  return segment->verifyChecksum();
+}
+
 /**
  * @brief Handle segment arrival event following the TCP state machine rule.
  * Please read RFC 793 section 3.9 for comprehensive and detailed guidance.
@@ -38,6 +101,15 @@ void SocketSession::signalUser(CallbackMessage message) {
  * @param segment
  */
 void SocketSession::onSegmentArrival(std::unique_ptr<Segment> segment) {
+  if (segment->isSYN()) {
+    factory_.onPeerWindowScale(segment->window_scale_);
+  }
+  if (segment->data_length_ > 0 && tcb_.receive.SYN_received) {
+    // the RTT is sampled as the data arrives, not as it is read
+    receive_tuner_.onArrival(tcb_.receive.next, receive_buffer_->free(),
+                             alarm_factory_->now());
+  }
+
   switch (state_) {
     // LAB: insert your code here.
 
@@ -5,8 +5,9 @@
 #ifndef SRC_TCP_SOCKET_SESSION_H
 #define SRC_TCP_SOCKET_SESSION_H
 
-#include "../base/ring_buffer.h"
+#include "../base/mirrored_ring_buffer.h"
 #include "control_block.h"
+#include "receive_tuner.h"
 #include "segment.h"
 #include "segment_factory.h"
 #include "send_buffer.h"
@@ -71,10 +72,24 @@ public:
 
   void onSegmentArrival(std::unique_ptr<Segment> segment);
 
+  // Verify the checksum of a parsed segment before |onSegmentArrival|.
+  bool stageSegment(Segment *segment);
+
   size_t send(char *data, size_t length);
 
   size_t receive(char *data, size_t length);
 
+  /**
+   * @brief Resize the receive buffer after data arrived or was received by
+   * the user, @see ReceiveTuner
+   * @param unread bytes taken by |receive| that the application has not
+   * read yet, they count as not drained.
+   */
+  void adjustReceiveBuffer(size_t unread);
+
+  // Bounds of the receive buffer, call it before the session is opened.
+  void setReceiveBufferLimits(size_t min_size, size_t max_size);
+
   void open();
 
   void open(std::unique_ptr<Segment> segment);
@@ -87,6 +102,12 @@ public:
 
   inline ConnectionState state() const { return state_; }
 
+  // Bytes the session can hold for each direction.
+  inline size_t sendBufferSize() const { return send_buffer_->capacity(); }
+  inline size_t receiveBufferSize() const {
+    return receive_buffer_->capacity();
+  }
+
   SocketAddress getLocalAddress() const;
   SocketAddress getRemoteAddress() const;
 
@@ -124,18 +145,18 @@ private:
   // user interface, not owned
   Callback *callback_;
 
-  std::unique_ptr<RingBuffer> receive_buffer_;
+  std::unique_ptr<MirroredRingBuffer> receive_buffer_;
+  ReceiveTuner receive_tuner_;
 
   AlarmFactory *alarm_factory_;
 
   void enterCLOSED();
 
-  DEFINE_ALARM_DELEGATE(TimeWaitDelegate, SocketSession, enterCLOSED);
   /**
    * Alarm for TIME_WAIT state.
    * Transmit the state to CLOSED after two MSL
    */
-  std::unique_ptr<Alarm> time_wait_alarm_;
+  MemberAlarm<SocketSession, &SocketSession::enterCLOSED> time_wait_alarm_;
 };
 
 #endif // SRC_TCP_SOCKET_SESSION_H
@@ -0,0 +1,31 @@
+//
+// Created by agent on 2026/10/18.
+//
+
+#ifndef SRC_TCP_TCP_HEADER_H
+#define SRC_TCP_TCP_HEADER_H
+
+#include "../base/header_layout.h"
+#include "./type.h"
+
+/**
+ * @brief Field layout of the TCP header without options.
+ */
+struct TcpHeader {
+  static constexpr size_t kLength = kTcpHeaderLength;
+
+  typedef HeaderField<SocketPort, 0> SourcePort;
+  typedef HeaderField<SocketPort, 2> DestinationPort;
+  typedef HeaderField<SequenceNumber, 4> Sequence;
+  typedef HeaderField<SequenceNumber, 8> Acknowledgment;
+  // the header length in 32-bit words in the high nibble
+  typedef HeaderField<uint8_t, 12> DataOffset;
+  typedef HeaderField<uint8_t, 13> Flags;
+  typedef HeaderField<WindowSize, 14> Window;
+  typedef HeaderField<uint16_t, 16> Checksum;
+  typedef HeaderField<uint16_t, 18> UrgentPointer;
+
+  static_assert(UrgentPointer::kEnd == kLength, "TCP header layout");
+};
+
+#endif // SRC_TCP_TCP_HEADER_H
@@ -3,6 +3,7 @@
 //
 
 #include "mock_alarm_factory.h"
+#include "../base/embedded_alarm.h"
 #include "mock_alarm.h"
 #include "gtest/gtest.h"
 
@@ -22,6 +23,19 @@ void MockAlarmFactory::unregisterAlarm(AlarmToken token) {
   alarm_map_.erase(token);
 }
 
+void MockAlarmFactory::registerAlarm(EmbeddedAlarm *alarm) {
+  registerAlarm(static_cast<Alarm *>(alarm));
+}
+
+void MockAlarmFactory::unregisterAlarm(EmbeddedAlarm *alarm) {
+  for (auto iter = alarm_map_.begin(); iter != alarm_map_.end(); iter++) {
+    if (iter->second == alarm) {
+      alarm_map_.erase(iter);
+      return;
+    }
+  }
+}
+
 MockAlarmFactory::MockAlarmFactory() : now_(0) {}
 
 void MockAlarmFactory::elapse(TimeBase::Delta delta) {
@@ -27,6 +27,9 @@ public:
   AlarmToken registerAlarm(Alarm *alarm);
   void unregisterAlarm(AlarmToken token);
 
+  void registerAlarm(EmbeddedAlarm *alarm) override;
+  void unregisterAlarm(EmbeddedAlarm *alarm) override;
+
   void elapse(TimeBase::Delta delta);
 
   bool runAlarmEvent();
@@ -12,6 +12,9 @@ bool MockIPLayer::sendPacket(IPAddress source, IPAddress destination,
 
   std::unique_ptr<Segment> segment =
       Segment::parse(source, destination, static_cast<char *>(buf), length);
+  if (segment == nullptr) {
+    return false;
+  }
   segment->copyData();
 
   DLOG(INFO) << "-> " << *segment;